@@ -0,0 +1,77 @@
+/*
+ * Run a gab program with an os_objalloc hook which counts the memory the
+ * engine asks for, and report how much it used.
+ *
+ *  cc -std=c2x -O2 -I../../include -I../../vendor -DGAB_PLATFORM_UNIX \
+ *    -D_POSIX_C_SOURCE=200809L alloc.c ../../src/cgab/*.c ../../src/mod/*.c \
+ *    ../../src/gab/os.c -lm -ldl -o alloc && ./alloc
+ */
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gab.h"
+
+struct counts {
+  _Atomic uint64_t live, peak, allocs, frees;
+};
+
+static void *counting_alloc(void *ctx, void *ptr, uint64_t size) {
+  struct counts *c = ctx;
+
+  if (ptr) {
+    atomic_fetch_sub(&c->live, size);
+    atomic_fetch_add(&c->frees, 1);
+    free(ptr);
+    return nullptr;
+  }
+
+  ptr = malloc(size);
+
+  if (ptr == nullptr)
+    return nullptr;
+
+  uint64_t live = atomic_fetch_add(&c->live, size) + size;
+  atomic_fetch_add(&c->allocs, 1);
+
+  uint64_t peak = atomic_load(&c->peak);
+  while (live > peak && !atomic_compare_exchange_weak(&c->peak, &peak, live))
+    ;
+
+  return ptr;
+}
+
+static const char *program = "\\do_sum:defcase! {\n"
+                             "  .true (n acc) => acc\n"
+                             "  .false (n acc) => (n - 1):sum(acc + n)\n"
+                             "}\n"
+                             "\\sum:def!('gab.number' acc => do\n"
+                             "  [self, { .n self }]\n"
+                             "  (self < 1):do_sum(self acc)\n"
+                             "end)\n"
+                             "100000:sum(0)\n";
+
+int main(void) {
+  struct counts c = {0};
+
+  struct gab_triple gab = gab_create((struct gab_create_argt){
+      .flags = fGAB_ENV_EMPTY,
+      .os_objalloc = counting_alloc,
+      .os_objalloc_ctx = &c,
+  });
+
+  // The results belong to the fiber which ran the program.
+  gab_exec(gab, (struct gab_exec_argt){
+                    .name = "alloc",
+                    .source = program,
+                    .flags = fGAB_ENV_EMPTY,
+                });
+
+  gab_destroy(gab);
+
+  printf("allocs %" PRIu64 " frees %" PRIu64 " peak %" PRIu64
+         " bytes, %" PRIu64 " bytes left to the arena\n",
+         c.allocs, c.frees, c.peak, c.live);
+
+  return 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * Throughput of the string hash against FNV-1a, for a range of lengths.
+ *
+ *  cc -O2 -I../../include hash.c -o hash && ./hash
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "hash.h"
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Hash roughly this many bytes for each measurement.
+#define TOTAL ((uint64_t)1 << 28)
+
+static volatile uint64_t sink;
+
+int main(void) {
+  static const uint64_t lens[] = {6, 8, 16, 32, 64, 256, 1024, 4096, 65536};
+  uint8_t *buf = malloc(65536 + 64);
+
+  for (uint64_t i = 0; i < 65536 + 64; i++)
+    buf[i] = rand();
+
+  printf("%8s %12s %12s\n", "len", "fnv1a MB/s", "hash MB/s");
+
+  for (uint64_t i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+    uint64_t len = lens[i], n = TOTAL / len, h = 0;
+
+    double start = now();
+    for (uint64_t j = 0; j < n; j++)
+      h += FNV1a_64(buf + (j & 63), len);
+    double fnv = now() - start;
+
+    start = now();
+    for (uint64_t j = 0; j < n; j++)
+      h += hash_bytes(0x9e3779b97f4a7c15, len, buf + (j & 63));
+    double wy = now() - start;
+
+    sink = h;
+    printf("%8lu %12.0f %12.0f\n", len, TOTAL / fnv / 1e6, TOTAL / wy / 1e6);
+  }
+
+  free(buf);
+  return 0;
+}
@@ -51,6 +51,8 @@ OP_CODE(LOCALSEND_BLOCK)
 OP_CODE(LOCALTAILSEND_BLOCK)
 OP_CODE(MATCHSEND_BLOCK)
 OP_CODE(MATCHTAILSEND_BLOCK)
+OP_CODE(SEND_POLYMORPHIC)
+OP_CODE(SEND_MEGAMORPHIC)
 OP_CODE(SEND_NATIVE)
 OP_CODE(SEND_CONSTANT)
 OP_CODE(SEND_PROPERTY)
@@ -97,3 +99,5 @@ OP_CODE(SEND_PRIMITIVE_CALL_MESSAGE_CONSTANT)
 OP_CODE(SEND_PRIMITIVE_CALL_MESSAGE_NATIVE)
 OP_CODE(SEND_PRIMITIVE_CALL_MESSAGE_BLOCK)
 OP_CODE(TAILSEND_PRIMITIVE_CALL_MESSAGE_BLOCK)
+OP_CODE(LOAD_LOCAL_CONSTANT_SEND_NUMERIC)
+OP_CODE(NLOAD_LOCAL_SEND_NUMERIC)
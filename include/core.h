@@ -14,21 +14,41 @@
 #error "cGAB_SEND_CACHE_LEN must be at least 4"
 #endif
 
+// The number of entries in each job's lookup cache for megamorphic sends.
+// Must be a power of 2.
+#ifndef cGAB_SEND_MEGACACHE_LEN
+#define cGAB_SEND_MEGACACHE_LEN 256
+#endif
+
 // Use __builtin_expect to aid the compiler
 // in choosing hot/cold code paths in the interpreter.
 #ifndef cGAB_LIKELY
 #define cGAB_LIKELY 1
 #endif
 
-// Limit the prefix length of a string that gab will hash.
-// This means that strings with an identical prefix of length cGAB_STRING_HASHLEN
-// will hash to the same value - even if they are different *after* that prefix.
-// This puts a cap on how *much* time gab will spend hashing strings - but
-// it is a tradeoff, because all strings that share that prefix will basically
-// be in a linked-list. (hash-bucket-chaining, etc)
-// If this macro is 0, then gab will not limit hashing.
-#ifndef cGAB_STRING_HASHLEN
-#define cGAB_STRING_HASHLEN 0
+// The string intern table is split into this many shards, each behind its own
+// lock, so that jobs interning different strings rarely wait on each other.
+// Must be a power of 2.
+#ifndef cGAB_STRING_SHARDS
+#define cGAB_STRING_SHARDS 16
+#endif
+
+// Concatenating strings into one at least this long makes a builder string,
+// which isn't interned and shares its bytes with strings appended to it.
+#ifndef cGAB_STRING_BUILDER_MIN
+#define cGAB_STRING_BUILDER_MIN 128
+#endif
+
+// Strings and binaries at least this long aren't interned, unless they are
+// made into a key, message or sigil. Their hash is computed when first needed.
+#ifndef cGAB_STRING_LARGE_MIN
+#define cGAB_STRING_LARGE_MIN 128
+#endif
+
+// The number of entries in each job's cache of strings it recently interned.
+// Must be a power of 2.
+#ifndef cGAB_STRING_CACHE_LEN
+#define cGAB_STRING_CACHE_LEN 64
 #endif
 
 // Combine common consecutive instruction patterns into one superinstruction
@@ -50,6 +70,12 @@
 
 #define GAB_CHANNEL_STEP_NS ((size_t)(cGAB_CHANNEL_STEP_MS * 1000000))
 
+// The largest buffer a channel may be made with. Each slot is allocated up
+// front, so this keeps a stray number from asking for all of memory.
+#ifndef cGAB_CHANNEL_MAX_LEN
+#define cGAB_CHANNEL_MAX_LEN ((size_t)1 << 16)
+#endif
+
 // Workers (os threads that can actually run gab code)
 // will wait this long before exiting, if they haven't received work.
 // New workers are spawned as needed up until a maximum is reached (specified at runtime)
@@ -58,6 +84,26 @@
 #define cGAB_WORKER_IDLEWAIT_MS ((size_t) 496)
 #endif
 
+// Each worker has a deque of fibers waiting to be run, which
+// starts out with this capacity and doubles as needed. Must be a power of two.
+#ifndef cGAB_WORKER_DEQUE_INITIAL_CAP
+#define cGAB_WORKER_DEQUE_INITIAL_CAP 64
+#endif
+
+// Objects are allocated from slabs of this many bytes. Each slab is carved
+// into slots of one size class, and belongs to the job which allocates from it.
+#ifndef cGAB_SLAB_SIZE
+#define cGAB_SLAB_SIZE ((size_t)1 << 16)
+#endif
+
+// The largest slot in a slab, in bytes. Objects which don't fit (with their
+// slot's header) are allocated with calloc instead.
+#ifndef cGAB_SLAB_MAXSLOT
+#define cGAB_SLAB_MAXSLOT 512
+#endif
+
+#define GAB_SLAB_NCLASSES (cGAB_SLAB_MAXSLOT / 16)
+
 // A worker (os thread) may need to yield at an arbitrary point.
 // This is done using the gab_yield function, which handles
 // sleeping, context switching, and checking if the worker needs
@@ -120,27 +166,79 @@
 #define cGAB_INTERN_INITIAL_CAP 256
 #endif
 
+// Initial capacity of the engine's (message, type) dispatch index.
+// Must be a power of 2.
+#ifndef cGAB_DISPATCH_INITIAL_CAP
+#define cGAB_DISPATCH_INITIAL_CAP 256
+#endif
+
 // Initial capacity of module constant table
 #ifndef cGAB_CONSTANTS_INITIAL_CAP
 #define cGAB_CONSTANTS_INITIAL_CAP 64
 #endif
 
-// Size of the vm's stack
+// Initial size of a fiber's stack
+#ifndef cGAB_STACK_INITIAL
+#define cGAB_STACK_INITIAL 128
+#endif
+
+// Slots allocated past a fiber stack's capacity.
+// Frames only reserve their locals, so this absorbs their temporaries.
+#ifndef cGAB_STACK_HEADROOM
+#define cGAB_STACK_HEADROOM 256
+#endif
+
+// Maximum size of the vm's stack
 #ifndef cGAB_STACK_MAX
 #define cGAB_STACK_MAX (cGAB_FRAMES_MAX * 128)
 #endif
 
-// Garbage collection increment/decrement buffer size
-// I don't love having these just be static buffers, its very possible
-// for them to overflow
+// Number of queued increments/decrements which triggers a garbage collection
 #ifndef cGAB_GC_MOD_BUFF_MAX
 #define cGAB_GC_MOD_BUFF_MAX (cGAB_STACK_MAX * 4)
 #endif
 
-#if cGAB_GC_MOD_BUFF_MAX <= cGAB_STACK_MAX
-#error "cGAB_GC_MOD_BUFF_MAX must be greater than to cGAB_STACK_MAX"
+// Garbage collection buffers grow in chunks of this many objects
+#ifndef cGAB_GC_MOD_CHUNK_LEN
+#define cGAB_GC_MOD_CHUNK_LEN 1024
+#endif
+
+// Maximum number of unused chunks kept around for reuse
+#ifndef cGAB_GC_MOD_CHUNK_POOL
+#define cGAB_GC_MOD_CHUNK_POOL 64
+#endif
+
+// Maximum number of dead objects freed in one slice
+#ifndef cGAB_GC_FREE_BUDGET
+#define cGAB_GC_FREE_BUDGET (1 << 14)
+#endif
+
+// Maximum time, in nanoseconds, spent freeing dead objects in one slice
+#ifndef cGAB_GC_FREE_BUDGET_NS
+#define cGAB_GC_FREE_BUDGET_NS 1000000
+#endif
+
+// Number of objects visited looking for garbage cycles in one collection,
+// unless more roots than that are waiting
+#ifndef cGAB_GC_CYCLE_BUDGET
+#define cGAB_GC_CYCLE_BUDGET (1 << 14)
 #endif
 
+// Maximum number of threads which help the gc job through a collection
+#ifndef cGAB_GC_HELPERS_MAX
+#define cGAB_GC_HELPERS_MAX 7
+#endif
+
+// Minimum number of objects in a pass of a collection to share it with helpers
+#ifndef cGAB_GC_HELP_MIN
+#define cGAB_GC_HELP_MIN (cGAB_GC_MOD_CHUNK_LEN * 8)
+#endif
+
+#if cGAB_STACK_INITIAL > cGAB_STACK_MAX
+#error "cGAB_STACK_INITIAL must be less than or equal to cGAB_STACK_MAX"
+#endif
+
+
 // Not configurable, just constants
 #define GAB_CONSTANTS_MAX (UINT16_MAX + 1)
 // Maximum value of a local.
@@ -172,6 +270,15 @@
 #define GAB_SEND_KGENERIC_CALL_SPECS 5
 #define GAB_SEND_KGENERIC_CALL_MESSAGE 6
 
+// Polymorphic (and local match) sends keep cGAB_SEND_CACHE_LEN lines of
+// cache after the monomorphic one. Line i of these begins at
+// (GAB_SEND_KPOLY + i * GAB_SEND_CACHE_SIZE).
+#define GAB_SEND_KPOLY GAB_SEND_CACHE_SIZE
+
+// The number of constants reserved for a single send site.
+#define GAB_SEND_NKS                                                           \
+  (GAB_SEND_KTYPE + GAB_SEND_CACHE_SIZE * (cGAB_SEND_CACHE_LEN + 1))
+
 // #define GAB_CALL_CACHE_SIZE 4
 // #define GAB_CALL_CACHE_LEN ((cGAB_SEND_CACHE_LEN * GAB_SEND_CACHE_SIZE) /
 // GAB_CALL_CACHE_SIZE)
@@ -180,7 +287,9 @@
 // #error Invalid GAB_CALL_CACHE_SIZE
 // #endif
 
-#define GAB_SEND_HASH(t) (t & (cGAB_SEND_CACHE_LEN - 1))
+// Object types are aligned pointers, so mix in some higher bits.
+#define GAB_SEND_HASH(t)                                                       \
+  (((t) ^ ((t) >> 4) ^ ((t) >> 9)) & (cGAB_SEND_CACHE_LEN - 1))
 // #define GAB_CALL_HASH(t) (t & (cGAB_CALL_CACHE_LEN - 1))
 
 #define GAB_PVEC_BITS (5)
@@ -217,6 +326,11 @@ enum gab_flags {
 #define GAB_VERSION_MAJOR "0"
 #define GAB_VERSION_MINOR "1"
 
+// Gab's binary object format (gbof), which \use caches compiled modules in.
+// Bump the version whenever its layout changes.
+#define GAB_GBOF_MAGIC "GBOF"
+#define GAB_GBOF_VERSION 1
+
 // Message constants
 #define mGAB_LT "<"
 #define mGAB_GT ">"
@@ -180,8 +180,16 @@ LINKAGE void METHOD(cap)(TYPENAME *self, size_t cap) {
 }
 
 LINKAGE bool METHOD(insert)(TYPENAME *self, K key, V val) {
-  if (self->len >= (self->cap * LOAD))
-    METHOD(cap)(self, MAX(self->cap * 2, 8));
+  if (self->len >= (self->cap * LOAD)) {
+    // Tombstones count towards the load. Rehash in place if removals left
+    // most of the table empty, instead of growing without bound.
+    size_t live = 0;
+    for (size_t i = 0; i < self->cap; i++)
+      live += self->buckets[i].status == D_FULL;
+
+    METHOD(cap)
+    (self, live * 2 >= self->cap * LOAD ? MAX(self->cap * 2, 8) : self->cap);
+  }
 
   size_t index = METHOD(index_of)(self, key);
 
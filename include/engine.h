@@ -27,16 +27,134 @@ a_gab_value *gab_vmexec(struct gab_triple gab, gab_value fiber);
 
 bool gab_wkspawn(struct gab_triple gab);
 
+/*
+ * Put a value on the channel without blocking. On an unbuffered channel,
+ * this only offers the value - it is not yet taken when this returns.
+ *
+ * Returns false if the channel is full.
+ */
+bool gab_chntryput(struct gab_triple gab, gab_value channel, gab_value value);
+
+/*
+ * Take a value from the channel without blocking.
+ *
+ * Returns gab_undefined if the channel is empty.
+ */
+gab_value gab_chntrytake(struct gab_triple gab, gab_value channel);
+
+/*
+ * Put a parked fiber in line on its channel, until the channel is ready for
+ * what the fiber is waiting for. Whoever makes it ready resumes the fiber.
+ */
+void gab_chnpark(struct gab_triple gab, gab_value fiber);
+
+/*
+ * Put a fiber which was parked on a channel back in line to be run.
+ */
+void gab_fibresume(struct gab_triple gab, gab_value fiber);
+
+void gab_parkercreate(struct gab_parker *p);
+
+void gab_parkerdestroy(struct gab_parker *p);
+
+/*
+ * The parker of the calling thread.
+ */
+struct gab_parker *gab_thisparker(struct gab_triple gab);
+
+/*
+ * Sleep until woken by gab_unpark, or until timeout_ns passes.
+ * A wakeup which happened before parking is not lost.
+ *
+ * Returns false if the timeout passed. Spurious wakeups are possible,
+ * so callers should re-check their condition.
+ */
+bool gab_park(struct gab_parker *p, uint64_t timeout_ns);
+
+void gab_unpark(struct gab_parker *p);
+
+void gab_wlcreate(struct gab_waitlist *wl);
+
+void gab_wldestroy(struct gab_waitlist *wl);
+
+/*
+ * Add p to the waitlist. Unless waiting through gab_wlwait, the caller
+ * must re-check its condition after adding itself and before parking, or a
+ * wakeup could be missed.
+ */
+void gab_wladd(struct gab_waitlist *wl, struct gab_parker *p);
+
+void gab_wlremove(struct gab_waitlist *wl, struct gab_parker *p);
+
+/*
+ * Wake (and remove) every waiter. Call this after changing the state the
+ * waiters are interested in.
+ */
+void gab_wlnotify(struct gab_waitlist *wl);
+
+/*
+ * Wake (and remove) one waiter. Only use this when any waiter could handle
+ * the change on its own - like a single value put on a channel.
+ */
+void gab_wlnotifyone(struct gab_waitlist *wl);
+
+/*
+ * Return a key for the waitlist's current state. Take a key, check the
+ * condition, and only then gab_wlwait on the key if the condition failed.
+ */
+uint64_t gab_wlkey(struct gab_waitlist *wl);
+
+/*
+ * Park the calling thread on the waitlist until it is notified, or
+ * until the timeout passes. If the waitlist was notified since key was
+ * taken, return immediately. Returns false if the timeout passed.
+ */
+bool gab_wlwait(struct gab_triple gab, struct gab_waitlist *wl, uint64_t key,
+                uint64_t timeout_ns);
+
 void gab_gccreate(struct gab_triple gab);
 
+/*
+ * Called by each collection, before it counts its roots. Rebuilds the
+ * dispatch index if a rebuild is pending, and frees the tables retired before
+ * the last collection.
+ *
+ * Returns the messages record the index mirrors, which the collection must
+ * keep alive - readers compare against it by address.
+ */
+gab_value gab_dispatchepoch(struct gab_triple gab);
+
 void gab_gcdestroy(struct gab_triple gab);
 
+/*
+ * Free a slice of the objects left dead by the last collection. Returns true
+ * if there are more left to free.
+ */
+bool gab_gcsweep(struct gab_triple gab);
+
 /*
  * Check if collection is necessary, and unblock the collection
  * thread if necessary
  */
 bool gab_gctrigger(struct gab_triple gab);
 
+/*
+ * Queue the decrement which balances the reference an object is made with.
+ */
+void gab_gcdrefnew(struct gab_triple gab, struct gab_obj *obj);
+
+/*
+ * Take a counted reference to an object found through a weak reference, unless
+ * it has already died. Returns false if it has.
+ */
+bool gab_gcweakref(struct gab_triple gab, struct gab_obj *obj);
+
+/*
+ * Make the values, and everything they refer to, immortal. They live for as
+ * long as the engine, and are left out of reference counting from now on.
+ */
+void gab_gcimmortal(struct gab_triple gab, uint64_t len, gab_value *values);
+
 /*
  * Begin the next epoch for the given pid
  */
@@ -58,22 +176,67 @@ enum variable_flag {
   fLOCAL_REST = 1 << 3,
 };
 
-static inline void *gab_egalloc(struct gab_triple gab, struct gab_obj *obj,
-                                uint64_t size) {
-  if (size == 0) {
-    assert(obj);
+/*
+ * Allocate a zero-initialized object of the given size, from a slab owned by
+ * the calling job. Free it by passing a size of 0.
+ *
+ * Any thread may free an object, no matter which job allocated it.
+ */
+struct gab_obj *gab_slaballoc(struct gab_triple gab, struct gab_obj *obj,
+                              uint64_t size);
 
-    free(obj);
+/*
+ * Allocate from slabs instead of the calling job's. The gc job shares wkid 0
+ * with the threads driving the engine from outside, so it calls this to keep
+ * each slab to a single owner.
+ */
+void gab_slabsown(struct gab_slabs *slabs);
+
+/*
+ * Release every slab. Any objects still in them are gone.
+ */
+void gab_slabdestroy(struct gab_triple gab);
 
-    return nullptr;
-  }
+/*
+ * Allocate or free an object through the embedder's os_objalloc hook.
+ */
+struct gab_obj *gab_hookalloc(struct gab_triple gab, struct gab_obj *obj,
+                              uint64_t size);
+
+/*
+ * Allocate, grow and free buffers which aren't objects themselves - fiber
+ * stacks, string buffers and gc chunks. These go through the os_objalloc hook
+ * too, when there is one.
+ *
+ * Running out of memory in gab_egmalloc is fatal. gab_egrealloc returns
+ * nullptr instead, and leaves the buffer as it was.
+ */
+void *gab_egmalloc(struct gab_eg *eg, uint64_t size);
 
-  assert(!obj);
+void *gab_egrealloc(struct gab_eg *eg, void *ptr, uint64_t size);
 
-  // Use 'calloc' to zero-initialize all the memory.
-  return calloc(1, size);
+void gab_egfree(struct gab_eg *eg, void *ptr);
+
+static inline void *gab_egalloc(struct gab_triple gab, struct gab_obj *obj,
+                                uint64_t size) {
+  assert(size == 0 ? obj != nullptr : obj == nullptr);
+  return gab.eg->objalloc(gab, obj, size);
 }
 
+/*
+ * The shard of the string intern table which a string with this hash belongs
+ * to. The table itself indexes by the low bits of the hash, so the shard is
+ * picked by the high bits.
+ */
+static inline struct gab_strshard *gab_egstrshard(struct gab_eg *gab,
+                                                  uint64_t hash) {
+  return gab->strings + ((hash >> 32) & (cGAB_STRING_SHARDS - 1));
+}
+
+/*
+ * Find a live, interned string. The caller holds the lock of the string's
+ * shard.
+ */
 struct gab_obj_string *gab_egstrfind(struct gab_eg *gab, uint64_t hash,
                                      uint64_t len, const char *data);
 
@@ -277,26 +277,32 @@ static inline gab_value __gab_dtoval(double value) {
 /* Convenience macro for getting arguments in builtins */
 #define gab_arg(i) (i < argc ? argv[i] : gab_nil)
 
-/* Convenience macro for comparing values */
-#define gab_valeq(a, b) ((a) == (b))
-
 /*
- * Gab uses a purely RC garbage collection approach.
+ * Gab uses a purely RC garbage collection approach, backed up by trial
+ * deletion to find garbage cycles.
  *
  * The algorithm is described in this paper:
  * https://researcher.watson.ibm.com/researcher/files/us-bacon/Bacon03Pure.pdf
  */
+#define fGAB_OBJ_ROOT (1 << 0)
+#define fGAB_OBJ_CYCLIC (1 << 1)
+#define fGAB_OBJ_TOUCHED (1 << 2)
+#define fGAB_OBJ_ACYCLIC (1 << 3)
+#define fGAB_OBJ_IMMORTAL (1 << 4)
+#define fGAB_OBJ_FRESH (1 << 5)
 #define fGAB_OBJ_BUFFERED (1 << 6)
 #define fGAB_OBJ_NEW (1 << 7)
 #define fGAB_OBJ_FREED (1 << 8) // Used for debug purposes
 
 #define GAB_OBJ_IS_BUFFERED(obj) ((obj)->flags & fGAB_OBJ_BUFFERED)
 #define GAB_OBJ_IS_NEW(obj) ((obj)->flags & fGAB_OBJ_NEW)
+#define GAB_OBJ_IS_IMMORTAL(obj) ((obj)->flags & fGAB_OBJ_IMMORTAL)
 #define GAB_OBJ_IS_FREED(obj) ((obj)->flags & fGAB_OBJ_FREED)
 
 #define GAB_OBJ_BUFFERED(obj) ((obj)->flags |= fGAB_OBJ_BUFFERED)
 #define GAB_OBJ_NEW(obj) ((obj)->flags |= fGAB_OBJ_NEW)
 #define GAB_OBJ_FREED(obj) ((obj)->flags |= fGAB_OBJ_FREED)
+#define GAB_OBJ_IMMORTAL(obj) ((obj)->flags |= fGAB_OBJ_IMMORTAL)
 
 #define __KEEP_FLAGS (fGAB_OBJ_BUFFERED | fGAB_OBJ_NEW | fGAB_OBJ_FREED)
 
@@ -362,16 +368,21 @@ struct gab_obj {
    * in a separate, slower rec<gab_obj, uint64_t>. When the reference count
    * drops back under 255, rc returns to the fast path.
    */
-  uint8_t references;
+  _Atomic uint8_t references;
   /**
    * @brief Flags used by garbage collection and for debug information.
    */
-  uint8_t flags;
+  _Atomic uint8_t flags;
   /**
    * @brief a flag denoting the kind of object referenced by this pointer -
    * defines how to interpret the remaining bytes of this allocation.
    */
   uint8_t kind;
+  /**
+   * @brief Scratch space for the cycle collector, while it is deciding
+   * whether this object is part of a garbage cycle. INT8_MAX otherwise.
+   */
+  int8_t trial;
 };
 
 /**
@@ -393,6 +404,12 @@ uint64_t gab_obj_size(struct gab_obj *obj);
 typedef a_gab_value *(*gab_osdynmod_load)(struct gab_triple, const char *path);
 typedef a_gab_value *(*gab_osdynmod)(struct gab_triple);
 
+/*
+ * Allocate 'size' bytes when 'ptr' is null. Otherwise, free 'ptr', which was
+ * allocated with 'size' bytes. The memory returned need not be zeroed.
+ */
+typedef void *(*gab_osobjalloc)(void *ctx, void *ptr, uint64_t size);
+
 /**
  * @class gab_create_argt
  */
@@ -405,6 +422,27 @@ struct gab_create_argt {
    * This is used to load native-c modules.
    */
   gab_osdynmod_load os_dynmod;
+  /**
+   * @brief A directory to cache compiled modules in, so that \use can skip
+   * compiling a module whose source hasn't changed. If null, or if the
+   * directory doesn't exist, modules are always compiled.
+   */
+  const char *cache;
+  /**
+   * @brief A hook for allocating and freeing every gab object, and the
+   * engine's buffers. It is called
+   * from any of the engine's threads, with os_objalloc_ctx as its first
+   * argument. If null, objects are allocated from the engine's own slabs.
+   *
+   * If the hook returns null, the engine reports that it is out of memory
+   * and exits. The one exception is growing a fiber's stack, which panics
+   * the fiber with a stack overflow instead.
+   *
+   * Objects still alive when the engine is destroyed are not handed back to
+   * the hook - free the arena behind it instead.
+   */
+  gab_osobjalloc os_objalloc;
+  void *os_objalloc_ctx;
 };
 
 /**
@@ -487,11 +525,8 @@ int gab_nfprintf(FILE *stream, const char *fmt, uint64_t argc,
  *
  * When in c-code, it can be useful to create gab_objects which should be global
  * (ie, always kept alive).
- * Since gab_objects are allocated with one reference, this function does not
- * increment the rc of the value. It instead gives the engine 'ownership',
- * implying that when the engine is freed it should *decrement* the rc of the
- * value. The object will then be freed in the final collection, if its rc is <=
- * 0.
+ * The value, and everything it refers to, is made immortal - it lives for as
+ * long as the engine, and its rc is no longer counted.
  *
  * @param eg The engine.
  * @param value The value to keep.
@@ -571,11 +606,12 @@ gab_impl(struct gab_triple gab, gab_value message, gab_value receiver);
 /**
  * @brief Push any number of value onto the vm's internal stack.
  *
- * This is how c-natives return values to the runtime.
+ * This is how c-natives return values to the runtime. A native can push up
+ * to GAB_RET_MAX values - past that, the push fails.
  *
  * @param vm The vm to push the values onto.
  * @param value the value to push.
- * @return The number of values pushed (always one), 0 on err.
+ * @return The number of values pushed, 0 on err.
  */
 #define gab_vmpush(vm, ...)                                                    \
   ({                                                                           \
@@ -631,6 +667,17 @@ a_gab_value *gab_suse(struct gab_triple gab, const char *name);
  */
 a_gab_value *gab_use(struct gab_triple gab, gab_value name);
 
+/**
+ * @brief Run a module's main block the way \use does. Messages defined by the
+ * module are kept by the caller.
+ *
+ * @param gab The triple
+ * @param main The module's main block
+ * @return A heap-allocated slice of the values returned by the module, or
+ * nullptr if it failed.
+ */
+a_gab_value *gab_runmod(struct gab_triple gab, gab_value main);
+
 /**
  * @brief Put a module into the engine's import table.
  *
@@ -695,6 +742,116 @@ struct gab_build_argt {
  */
 gab_value gab_build(struct gab_triple gab, struct gab_build_argt args);
 
+/**
+ * @brief A prototype of a module which was compiled ahead of time.
+ * @see struct gab_load_argt.
+ */
+struct gab_load_prototype {
+  /**
+   * The constant which holds this prototype. The main prototype isn't held by
+   * any, so this is ignored for it.
+   */
+  uint16_t k;
+  /**
+   * The offset in the module's bytecode, and the length.
+   */
+  uint64_t offset, len;
+  /**
+   * The number of arguments, slots (stack space), locals and captures.
+   */
+  unsigned char narguments, nslots, nlocals, nupvalues;
+  /**
+   * Where each capture comes from.
+   */
+  const char *data;
+};
+
+/**
+ * @class gab_load_argt
+ * @brief A module which was compiled ahead of time, like one read by
+ * gab_loadgbof.
+ * @see gab_load.
+ */
+struct gab_load_argt {
+  /**
+   * The name of the module.
+   */
+  const char *name;
+  /**
+   * The module's source code. This isn't compiled, but is needed for errors.
+   */
+  const char *source;
+  /**
+   * Optional flags.
+   */
+  int flags;
+  /**
+   * The length of the module's bytecode.
+   */
+  uint64_t len;
+  /**
+   * The module's bytecode, and the token each byte was compiled from.
+   */
+  const uint8_t *bytecode;
+  const uint64_t *bytecode_toks;
+  /**
+   * The number of constants used by the bytecode.
+   */
+  uint64_t nconstants;
+  /**
+   * The constants used by the bytecode. Those which hold a prototype are
+   * filled in by gab_load.
+   */
+  const gab_value *constants;
+  /**
+   * The number of prototypes in the module.
+   */
+  uint64_t nprototypes;
+  /**
+   * The prototypes in the module. The last one is the main prototype.
+   */
+  const struct gab_load_prototype *prototypes;
+};
+
+/**
+ * @brief Load a module which was compiled ahead of time, skipping the
+ * parser and compiler entirely.
+ *
+ * @see struct gab_load_argt.
+ *
+ * @param gab The engine.
+ * @param args The arguments.
+ * @returns The main block, like gab_build. gab_undefined if a module by the
+ * same name is already loaded.
+ */
+gab_value gab_load(struct gab_triple gab, struct gab_load_argt args);
+
+/**
+ * @brief Write a module out in gab's binary object format (gbof). This is
+ * the format \use caches compiled modules in.
+ *
+ * @param stream The stream to write to.
+ * @param main The module's main block, as returned by gab_build.
+ * @returns 0 on success, or -1 if the module has a constant which can't be
+ * written out.
+ */
+int gab_fwritegbof(FILE *stream, gab_value main);
+
+/**
+ * @brief Load a module written by gab_fwritegbof.
+ *
+ * @param gab The engine.
+ * @param name The name of the module.
+ * @param source The module's source. The object is stale if it was written
+ * from a different source.
+ * @param len The length of the object.
+ * @param data The object.
+ * @returns The main block, like gab_build. gab_undefined if the object is stale
+ * or malformed.
+ */
+gab_value gab_loadgbof(struct gab_triple gab, const char *name,
+                       const char *source, uint64_t len, const uint8_t *data);
+
 gab_value gab_parse(struct gab_triple gab, struct gab_build_argt args);
 
 /**
@@ -1069,6 +1226,21 @@ void gab_ndref(struct gab_triple gab, uint64_t stride, uint64_t len,
  */
 void gab_collect(struct gab_triple gab);
 
+/**
+ * @brief Copy the garbage collector's pause histogram into buckets.
+ *
+ * Bucket 0 counts pauses under a microsecond, and bucket i counts pauses of
+ * [2^(i-1), 2^i) microseconds. The last bucket also counts anything longer.
+ * A pause is either one collection, or one slice of freeing the objects that
+ * a collection found dead.
+ *
+ * @param gab The engine
+ * @param len The number of buckets to copy, at most GAB_GCNPAUSES
+ * @param buckets The buckets to copy into
+ * @return The number of buckets copied
+ */
+uint64_t gab_gcpauses(struct gab_triple gab, uint64_t len, uint64_t *buckets);
+
 /**
  * @brief Lock the garbage collector to prevent collection until gab_gcunlock is
  * called.
@@ -1139,6 +1311,24 @@ static inline bool gab_valhast(gab_value value) {
   }
 }
 
+/**
+ * @brief How a string object holds its bytes.
+ *
+ * Only interned strings are identical to every string with the same bytes.
+ * The others are compared by their bytes (see gab_valeq), and are interned
+ * before becoming a key, message or sigil.
+ */
+enum gab_strrep {
+  /* The bytes follow the string, which is in the intern table. */
+  kGAB_STRREP_INTERNED,
+  /* The bytes are shared with longer strings built on top of this one. */
+  kGAB_STRREP_BUILDER,
+  /* The bytes follow the string, which is too long to intern. */
+  kGAB_STRREP_LARGE,
+  /* The bytes are borrowed from part of another string. */
+  kGAB_STRREP_SLICE,
+};
+
 /**
  * @brief An immutable sequence of bytes.
  */
@@ -1146,9 +1336,17 @@ struct gab_obj_string {
   struct gab_obj header;
 
   /**
-   * A pre-computed hash of the bytes in 'data'.
+   * An enum gab_strrep. Either kGAB_STRREP_INTERNED or kGAB_STRREP_LARGE for
+   * strings with 'data', see gab_obj_strbuilder and gab_obj_strslice for the
+   * others.
+   */
+  uint8_t rep;
+
+  /**
+   * A hash of the bytes in 'data'. Interned strings compute it up front, the
+   * others the first time it is asked for (zero until then).
    */
-  uint64_t hash;
+  _Atomic uint64_t hash;
 
   /**
    * The number of bytes in 'data'
@@ -1161,11 +1359,199 @@ struct gab_obj_string {
   char data[];
 };
 
+/**
+ * @brief A string made by concatenation.
+ *
+ * Its bytes are a prefix of a buffer, which is shared with the strings made by
+ * appending to it. Appending to the string which ends at the end of the buffer
+ * doesn't copy what came before, so building a string out of many pieces
+ * takes linear time.
+ */
+struct gab_obj_strbuilder {
+  struct gab_obj header;
+
+  /**
+   * kGAB_STRREP_BUILDER.
+   */
+  uint8_t rep;
+
+  /**
+   * The hash of the bytes, once it has been computed. Zero until then.
+   */
+  _Atomic uint64_t hash;
+
+  /**
+   * The number of bytes in the string.
+   */
+  uint64_t len;
+
+  /**
+   * The bytes followed by a null terminator, once something has asked for
+   * them. Either the buffer itself, or a copy if the buffer already went on
+   * past the end of this string.
+   */
+  char *_Atomic flat;
+
+  /**
+   * The buffer, which is freed with the last string to share it.
+   */
+  struct gab_strbuf {
+    _Atomic uint64_t rc;
+
+    /* The number of bytes claimed by strings so far. */
+    _Atomic uint64_t len;
+
+    uint64_t cap;
+
+    /* The engine the buffer, and any copies out of it, are allocated from. */
+    struct gab_eg *eg;
+
+    char data[];
+  } *buf;
+};
+
+/**
+ * @brief A string which is part of another.
+ *
+ * It keeps the other string alive, and points into its bytes instead of
+ * copying them. Splitting or trimming a long string doesn't copy it.
+ */
+struct gab_obj_strslice {
+  struct gab_obj header;
+
+  /**
+   * kGAB_STRREP_SLICE.
+   */
+  uint8_t rep;
+
+  /**
+   * Whether 'flat' borrows the parent's bytes rather than owning a copy. It
+   * is decided when the slice is made, so destroying the slice never has to
+   * look at the parent - which may already be gone.
+   */
+  bool borrowed;
+
+  /**
+   * The hash of the bytes, once it has been computed. Zero until then.
+   */
+  _Atomic uint64_t hash;
+
+  /**
+   * The number of bytes in the string.
+   */
+  uint64_t len;
+
+  /**
+   * The bytes followed by a null terminator, once something has asked for
+   * them. Either the parent's own bytes if this slice ends where the parent
+   * does (see borrowed), or a copy.
+   */
+  char *_Atomic flat;
+
+  /**
+   * The string whose bytes this is a part of. This is never itself a slice.
+   */
+  gab_value parent;
+
+  /**
+   * Where in the parent's bytes this string starts.
+   */
+  uint64_t offset;
+
+  /**
+   * The engine a copy of the bytes is allocated from.
+   */
+  struct gab_eg *eg;
+};
+
 /* Cast a value to a (gab_obj_string*) */
 #define GAB_VAL_TO_STRING(value) ((struct gab_obj_string *)gab_valtoo(value))
 
+/* Cast a value to a (gab_obj_strbuilder*) */
+#define GAB_VAL_TO_STRBUILDER(value)                                           \
+  ((struct gab_obj_strbuilder *)gab_valtoo(value))
+
+/* Cast a value to a (gab_obj_strslice*) */
+#define GAB_VAL_TO_STRSLICE(value)                                             \
+  ((struct gab_obj_strslice *)gab_valtoo(value))
+
+/**
+ * @brief Whether a value is identical to every value equal to it. This is true
+ * of everything but strings which aren't interned.
+ *
+ * @param value The value.
+ */
+static inline bool gab_valisinterned(gab_value value) {
+  if (!gab_valiso(value))
+    return true;
+
+  struct gab_obj_string *s = GAB_VAL_TO_STRING(value);
+  return s->header.kind != kGAB_STRING || s->rep == kGAB_STRREP_INTERNED;
+}
+
 /**
- * @brief Create a gab_value from a bounded array of chars.
+ * @brief INTERNAL: The bytes of a heap string, which aren't null-terminated
+ * for builders and slices. See gab_strdata.
+ */
+static inline const char *__gab_strbytes(struct gab_obj_string *s) {
+  switch (s->rep) {
+  case kGAB_STRREP_BUILDER:
+    return ((struct gab_obj_strbuilder *)s)->buf->data;
+  case kGAB_STRREP_SLICE: {
+    struct gab_obj_strslice *slice = (struct gab_obj_strslice *)s;
+    return __gab_strbytes(GAB_VAL_TO_STRING(slice->parent)) + slice->offset;
+  }
+  default:
+    return s->data;
+  }
+}
+
+/**
+ * @brief Compare two values. Strings which aren't interned are equal to any
+ * string with the same bytes - everything else is only equal to itself.
+ *
+ * @param a The first value.
+ * @param b The second value.
+ * @return true if the values are equal.
+ */
+static inline bool gab_valeq(gab_value a, gab_value b) {
+  if (a == b)
+    return true;
+
+  // Short strings and every other kind of value are only equal if identical,
+  // as are two strings of different kinds (ie: a string and a binary).
+  if (!gab_valiso(a) || !gab_valiso(b) || ((a ^ b) & __GAB_TAGBITS))
+    return false;
+
+  if (__gab_likely(gab_valisinterned(a) && gab_valisinterned(b)))
+    return false;
+
+  struct gab_obj_string *sa = GAB_VAL_TO_STRING(a);
+  struct gab_obj_string *sb = GAB_VAL_TO_STRING(b);
+
+  return sa->header.kind == sb->header.kind && sa->len == sb->len &&
+         !memcmp(__gab_strbytes(sa), __gab_strbytes(sb), sa->len);
+}
+
+/**
+ * @brief Intern a string which isn't interned already. Any other value is
+ * returned as is.
+ *
+ * @param gab The engine.
+ * @param value The value.
+ * @return A value which is identical to every value equal to it.
+ */
+gab_value gab_valintern(struct gab_triple gab, gab_value value);
+
+/**
+ * @brief INTERNAL: Get the null-terminated bytes of a builder or slice. See
+ * gab_strdata.
+ */
+const char *gab_strflat(struct gab_obj_string *str);
+
+/**
+ * @brief Create a gab_value from a bounded array of chars. Strings at least
+ * cGAB_STRING_LARGE_MIN bytes long are copied once and not interned.
  *
  * @param gab The engine.
  * @param len The length of the string.
@@ -1174,6 +1560,17 @@ struct gab_obj_string {
  */
 gab_value gab_nstring(struct gab_triple gab, uint64_t len, const char *data);
 
+/**
+ * @brief Create an interned string from a bounded array of chars, whatever its
+ * length. Use this for strings which will become keys, messages or sigils.
+ *
+ * @param gab The engine.
+ * @param len The length of the string.
+ * @param data The data.
+ * @return The value.
+ */
+gab_value gab_ninterned(struct gab_triple gab, uint64_t len, const char *data);
+
 /**
  * @brief Create a gab_value from a c-string
  *
@@ -1224,23 +1621,59 @@ static inline const char *gab_strdata(gab_value *str) {
   assert(gab_valkind(*str) == kGAB_STRING || gab_valkind(*str) == kGAB_SIGIL ||
          gab_valkind(*str) == kGAB_MESSAGE || gab_valkind(*str) == kGAB_SYMBOL);
 
-  if (gab_valiso(*str))
-    return GAB_VAL_TO_STRING(*str)->data;
+  if (gab_valiso(*str)) {
+    struct gab_obj_string *s = GAB_VAL_TO_STRING(*str);
+
+    if (__gab_likely(s->rep == kGAB_STRREP_INTERNED ||
+                     s->rep == kGAB_STRREP_LARGE))
+      return s->data;
+
+    return gab_strflat(s);
+  }
 
   return ((const char *)str);
 }
 
 /**
- * @brief Get a string's hash. This a constant-time.
+ * @brief Get a pointer to the start of the string, which may not be followed
+ * by a null terminator. Unlike gab_strdata, this never has to copy the string.
+ *
+ * @param str The string
+ * @return A pointer to the start of the string
+ */
+static inline const char *gab_strbytes(gab_value *str) {
+  if (gab_valiso(*str))
+    return __gab_strbytes(GAB_VAL_TO_STRING(*str));
+
+  return gab_strdata(str);
+}
+
+/**
+ * @brief INTERNAL: Hash the bytes of a string which isn't interned, the first
+ * time it is asked for. See gab_strhash.
+ */
+uint64_t gab_strlazyhash(struct gab_triple gab, struct gab_obj_string *str);
+
+/**
+ * @brief Get a string's hash. Strings which are equal have the same hash.
+ * This is constant-time, except the first time for strings which aren't
+ * interned.
  *
+ * @param gab The engine.
  * @param str The string
  * @return The hash
  */
-static inline uint64_t gab_strhash(gab_value str) {
+static inline uint64_t gab_strhash(struct gab_triple gab, gab_value str) {
   assert(gab_valkind(str) == kGAB_STRING);
 
-  if (gab_valiso(str))
-    return GAB_VAL_TO_STRING(str)->hash;
+  if (gab_valiso(str)) {
+    struct gab_obj_string *s = GAB_VAL_TO_STRING(str);
+
+    if (__gab_likely(s->rep == kGAB_STRREP_INTERNED))
+      return s->hash;
+
+    return gab_strlazyhash(gab, s);
+  }
 
   return str;
 }
@@ -1260,18 +1693,19 @@ static inline uint64_t gab_sstrendswith(gab_value str, const char *pat,
   return !memcmp(cstr + cstrlen - offset - len, pat, len);
 }
 
-static inline gab_value gab_strslice(struct gab_triple gab, gab_value str,
-                                     uint64_t offset, uint64_t len) {
-  assert(gab_valkind(str) == kGAB_STRING);
-
-  const char *cstr = gab_strdata(&str);
-  uint64_t cstrlen = gab_strlen(str);
-
-  offset = offset >= cstrlen ? cstrlen : offset;
-  len = offset + len > cstrlen ? cstrlen - offset : len;
-
-  return gab_nstring(gab, len, cstr + offset);
-};
+/**
+ * @brief Get part of a string. The offset and length are clamped to the
+ * string. A part of a long string which isn't interned borrows its bytes,
+ * instead of copying them.
+ *
+ * @param gab The engine.
+ * @param str The string.
+ * @param offset The offset of the first byte.
+ * @param len The number of bytes.
+ * @return The part of the string.
+ */
+gab_value gab_strslice(struct gab_triple gab, gab_value str, uint64_t offset,
+                       uint64_t len);
 
 /**
  * @brief Convert a string into it's corresponding sigil. This is constant-time.
@@ -1322,7 +1756,7 @@ static inline gab_value gab_strtobin(gab_value str) {
  */
 static inline gab_value gab_nmessage(struct gab_triple gab, uint64_t len,
                                      const char *data) {
-  return gab_strtomsg(gab_nstring(gab, len, data));
+  return gab_strtomsg(gab_ninterned(gab, len, data));
 }
 
 /**
@@ -1333,7 +1767,7 @@ static inline gab_value gab_nmessage(struct gab_triple gab, uint64_t len,
  * @return The new message object.
  */
 static inline gab_value gab_message(struct gab_triple gab, const char *data) {
-  return gab_strtomsg(gab_string(gab, data));
+  return gab_strtomsg(gab_ninterned(gab, strlen(data), data));
 }
 
 /**
@@ -1375,7 +1809,7 @@ static inline gab_value gab_sigtostr(gab_value sigil) {
  * @return The symbol
  */
 static inline gab_value gab_symbol(struct gab_triple gab, const char *data) {
-  return gab_strtosym(gab_string(gab, data));
+  return gab_strtosym(gab_ninterned(gab, strlen(data), data));
 }
 
 /**
@@ -1400,7 +1834,7 @@ static inline gab_value gab_nbinary(struct gab_triple gab, size_t len,
  * @return The sigil
  */
 static inline gab_value gab_sigil(struct gab_triple gab, const char *data) {
-  return gab_strtosig(gab_string(gab, data));
+  return gab_strtosig(gab_ninterned(gab, strlen(data), data));
 }
 
 /**
@@ -1412,7 +1846,7 @@ static inline gab_value gab_sigil(struct gab_triple gab, const char *data) {
  */
 static inline gab_value gab_nsigil(struct gab_triple gab, uint64_t len,
                                    const char *data) {
-  return gab_strtosig(gab_nstring(gab, len, data));
+  return gab_strtosig(gab_ninterned(gab, len, data));
 }
 
 /**
@@ -1528,8 +1962,19 @@ static inline uint64_t gab_shpfind(gab_value shp, gab_value key) {
 
   uint64_t len = s->len;
 
+  // Keys are interned when they are added to a shape, so only a key which
+  // isn't interned needs to be compared by its bytes.
+  if (__gab_unlikely(!gab_valisinterned(key))) {
+    for (uint64_t i = 0; i < len; i++) {
+      if (gab_valeq(key, s->keys[i]))
+        return i;
+    }
+
+    return -1;
+  }
+
   for (uint64_t i = 0; i < len; i++) {
-    if (gab_valeq(key, s->keys[i]))
+    if (key == s->keys[i])
       return i;
   }
 
@@ -1622,9 +2067,10 @@ struct gab_obj_rec {
   uint8_t len;
 
   /**
-   * @brief shift value used to index tree as depth increases.
+   * @brief shift value used to index tree as depth increases. A shift is at
+   * most 64 bits deep, so 1 byte is plenty here too.
    */
-  int32_t shift;
+  uint8_t shift;
 
   /**
    * @brief The shape of this record. This determines the length of the record
@@ -1898,6 +2344,51 @@ static inline uint64_t gab_recisl(gab_value rec) {
  */
 gab_value gab_recdel(struct gab_triple gab, gab_value record, gab_value key);
 
+/*
+ * @brief An os thread which can sleep until another thread wakes it.
+ */
+struct gab_parker {
+  mtx_t mtx;
+  cnd_t cnd;
+  bool signaled;
+
+  /*
+   * Whether the thread is currently asleep, and how many times it has gone
+   * to sleep. Together these tell if it slept through some interval.
+   */
+  bool sleeping;
+  uint64_t nsleeps;
+};
+
+#define T struct gab_parker *
+#define NAME gab_parker
+#include "vector.h"
+
+/*
+ * @brief The threads waiting on some shared state (like a channel) to change.
+ *
+ * Whoever changes the state wakes every waiter (or just one, if one is
+ * enough to handle the change), which then re-checks it.
+ */
+struct gab_waitlist {
+  mtx_t mtx;
+  _Atomic uint64_t len, seq;
+  v_gab_parker parkers;
+};
+
+/*
+ * @brief What a fiber parked on a channel is waiting for.
+ */
+enum gab_chnwait {
+  // Something to take.
+  kGAB_CHNWAIT_TAKE,
+  // Room to put.
+  kGAB_CHNWAIT_PUT,
+  // A taker for the value it put on an unbuffered channel.
+  kGAB_CHNWAIT_TAKER,
+  kGAB_CHNWAIT_NKINDS,
+};
+
 /*
  * @brief A lightweight green-thread / coroutine / fiber.
  */
@@ -1912,7 +2403,38 @@ struct gab_obj_fiber {
 
     gab_value *sp, *fp;
 
-    gab_value sb[cGAB_STACK_MAX];
+    /*
+     * The stack starts at cGAB_STACK_INITIAL slots, and is grown
+     * (and relocated) on demand up to cGAB_STACK_MAX.
+     */
+    gab_value *sb;
+    uint64_t cap;
+
+    /*
+     * The engine whose allocator the stack came from.
+     */
+    struct gab_eg *eg;
+
+    /*
+     * Saved when the fiber parks on a channel instead of blocking its
+     * worker. The parked instruction (at ip) is re-run once the channel
+     * is ready.
+     */
+    gab_value *kb;
+    gab_value channel;
+    enum gab_chnwait waiting;
+
+    /*
+     * The job whose copy of the bytecode the parked ip, kb and return
+     * addresses point into. Another job which resumes the fiber moves them
+     * over to its own copy first.
+     */
+    uint64_t wkid;
+
+    /*
+     * A parked put has already placed its value, and is waiting for a taker.
+     */
+    bool put_pending;
   } vm;
 
   /**
@@ -1920,6 +2442,16 @@ struct gab_obj_fiber {
    */
   gab_value messages;
 
+  /**
+   * Threads waiting for the fiber to finish
+   */
+  struct gab_waitlist waiters;
+
+  /**
+   * While parked, the fiber is linked into its job's list of parked fibers.
+   */
+  struct gab_obj_fiber *parked_prev, *parked_next;
+
   /**
    * Result of execution
    */
@@ -1988,6 +2520,17 @@ static inline gab_value gab_thisfibmsgat(struct gab_triple gab,
 static inline gab_value gab_thisfibmsgrec(struct gab_triple gab,
                                           gab_value message);
 
+/**
+ * @brief A slot in a buffered channel's ring.
+ *
+ * seq says whose turn it is: seq == pos means the slot is free for the put at
+ * pos, and seq == pos + 1 means it is full for the take at pos.
+ */
+struct gab_chnslot {
+  _Atomic uint64_t seq;
+  gab_value value;
+};
+
 /**
  * @brief A primitive for sending data between fibers.
  */
@@ -1995,24 +2538,60 @@ struct gab_obj_channel {
   struct gab_obj header;
 
   /**
-   * The atomic channel for communicating data betwixt fibers
+   * The atomic channel for communicating data betwixt fibers.
+   * Only used by unbuffered channels.
    */
   _Atomic gab_value data;
+
+  /**
+   * Threads waiting to take, and threads waiting to put (or for their put
+   * to be taken).
+   */
+  struct gab_waitlist takers, putters;
+
+  /**
+   * Fibers parked on the channel, in line for what they are waiting for. A
+   * put or take moves just the fibers it unblocks back onto a job's deque.
+   */
+  mtx_t mtx;
+  _Atomic uint64_t nparked;
+  struct gab_chnparked {
+    uint64_t head;
+    v_gab_value fibers;
+  } parked[kGAB_CHNWAIT_NKINDS];
+
+  /**
+   * The capacity of the buffer. Zero for an unbuffered channel.
+   */
+  uint64_t len;
+
+  /**
+   * The positions of the next take and the next put. They only grow, and
+   * index into the buffer modulo len.
+   */
+  _Atomic uint64_t head, tail;
+
+  /**
+   * The buffer, a bounded multi-producer multi-consumer ring.
+   */
+  struct gab_chnslot buffer[];
 };
 
 /**
  * @brief Create a channel with the given buffer capacity.
+ * A channel with a capacity of 0 is unbuffered - every put waits for a take.
  *
  * @param gab The engine
  * @param len The length of the channel's buffer
  * @return The channel
  */
-gab_value gab_channel(struct gab_triple gab);
+gab_value gab_channel(struct gab_triple gab, uint64_t len);
 
 /**
  * @brief Put a value on the given channel.
  *  In unbuffered channels, this will block the caller until the value is taken
- * by another fiber.
+ * by another fiber. In buffered channels, this only blocks while the buffer is
+ * full.
  *
  * @param gab The engine
  * @param channel The channel
@@ -2043,9 +2622,10 @@ gab_value gab_tchntake(struct gab_triple gab, gab_value channel, uint64_t nms);
 /**
  * @brief Close the given channel. A closed channel cannot receive new values.
  *
+ * @param gab The engine
  * @param channel The channel
  */
-void gab_chnclose(gab_value channel);
+void gab_chnclose(struct gab_triple gab, gab_value channel);
 
 /**
  * @brief Return true if the given channel is closed
@@ -2338,6 +2918,32 @@ static inline gab_value gab_valtype(struct gab_triple gab, gab_value value) {
 #define DEF_V (UINT8_MAX)
 #include "dict.h"
 
+/**
+ * @class A single (message, receiver) -> specialization slot in the engine's
+ * dispatch index. A slot is empty while its message is 0. Once a slot is
+ * claimed its key never changes, only its spec is overwritten.
+ */
+struct gab_dispatch_slot {
+  _Atomic gab_value message, receiver, spec;
+};
+
+/**
+ * @class An open-addressed table of dispatch slots, mirroring one messages
+ * record. Readers never lock: they check the table is mirroring their record
+ * and that seq didn't move while they probed. A table that has been replaced
+ * is retired, and freed two collections later - by then every job has passed
+ * an epoch boundary, so no reader can still be looking at it.
+ */
+struct gab_dispatch_table {
+  uint64_t len, cap;
+  /* Odd while the table is being changed in place. */
+  _Atomic uint64_t seq;
+  /* The messages record this table mirrors. */
+  _Atomic gab_value messages;
+  struct gab_dispatch_table *retired;
+  struct gab_dispatch_slot data[];
+};
+
 enum {
   kGAB_BUF_STK = 0,
   kGAB_BUF_INC = 1,
@@ -2346,6 +2952,18 @@ enum {
 };
 
 #define GAB_GCNEPOCHS 3
+#define GAB_GCNPAUSES 32
+
+/*
+ * The slabs one owner allocates objects from, one list per size class. The
+ * owner allocates from the first slab of each list without taking the lock.
+ * Changing the lists takes it - the gc job also frees slabs which are empty.
+ */
+struct gab_slabs {
+  mtx_t mtx;
+  struct gab_slab *head[GAB_SLAB_NCLASSES];
+};
+
 /**
  * @class The 'engine'. Stores the long-lived data
  * needed for the gab environment.
@@ -2353,6 +2971,7 @@ enum {
 struct gab_eg {
   uint64_t hash_seed;
 
+  mtx_t scratch_mtx;
   v_gab_value scratch;
 
   gab_value types[kGAB_NKINDS];
@@ -2361,22 +2980,129 @@ struct gab_eg {
 
   struct gab_gc {
     _Atomic int8_t schedule;
+    mtx_t overflow_mtx;
     d_gab_obj overflow_rc;
     v_gab_obj dead;
 
+    // A histogram of how long the gc job spends on each collection, and on
+    // each slice of freeing after one. See gab_gcpauses.
+    _Atomic uint64_t pauses[GAB_GCNPAUSES];
+
+    /*
+     * Threads which share the work of large collections with the gc job. They
+     * are started by the first collection which is big enough to share.
+     */
+    struct gab_gchelp {
+      bool sharing;
+      uint8_t phase;
+      uint64_t nhelpers;
+      _Atomic uint64_t next, active;
+
+      // The gc job sleeps here while the helpers finish a phase.
+      struct gab_parker parker;
+
+      uint64_t nwork, capwork;
+      struct gab_gcchunk **work;
+
+      struct gab_gchelper {
+        thrd_t td;
+        struct gab_parker parker;
+        v_gab_obj dead, roots;
+      } helpers[cGAB_GC_HELPERS_MAX];
+    } help;
+
+    /*
+     * Reference counting alone never frees a cycle. Objects which are
+     * decremented but stay alive are candidate roots of one. The gc job
+     * looks for garbage cycles under them by trial deletion, and holds on to
+     * what it finds until the next collection confirms it is still garbage.
+     */
+    struct gab_gccycles {
+      bool fail;
+      uint64_t budget;
+      v_gab_obj roots, white, stack, seen;
+    } cycles;
+
+    /*
+     * Chunks which are no longer in use by any buffer. Buffers take from
+     * here when they fill up, and give back when they are cleared.
+     */
+    struct gab_gcpool {
+      mtx_t mtx;
+      uint64_t len;
+      struct gab_gcchunk *free;
+    } pool;
+
     struct gab_gcbuf {
       uint64_t len;
-      struct gab_obj *data[cGAB_GC_MOD_BUFF_MAX];
+      struct gab_gcchunk {
+        struct gab_gcchunk *next;
+        uint64_t len;
+        struct gab_obj *data[cGAB_GC_MOD_CHUNK_LEN];
+      } *head, *tail;
     } buffers[][kGAB_NBUF][GAB_GCNEPOCHS];
   } *gc;
 
-  gab_value messages, work_channel;
+  /*
+   * Slabs the gc job allocates objects from. It shares wkid 0 with the
+   * threads driving the engine from outside, which use jobs[0]'s.
+   */
+  struct gab_slabs gcslabs;
+
+  gab_value messages;
+
+  /*
+   * Fibers scheduled from outside of a job (ie: the main thread), waiting
+   * for any job to take them. Fibers scheduled by a job go onto its own
+   * deque instead.
+   */
+  struct gab_inject {
+    mtx_t mtx;
+    _Atomic uint64_t len;
+    uint64_t head;
+    v_gab_value fibers;
+  } inject;
+
+  /*
+   * Jobs with nothing to run sleep here until new work is scheduled.
+   */
+  struct gab_waitlist idle;
+
+  /*
+   * Woken when a job exits or goes idle, or the gc finishes a collection.
+   */
+  struct gab_waitlist lifecycle;
+
+  _Atomic bool shutdown;
+
+  /*
+   * An index of every specialization in one messages record, keyed by
+   * (message, receiver), so that lookups skip the nested record. Jobs read
+   * the table without locking, under its seqlock. A def that doesn't build
+   * on the mirrored record leaves the new record pending, and the next
+   * collection rebuilds the table for it. Replaced tables wait in reclaim
+   * for a collection, when no job can still be reading them.
+   */
+  struct gab_dispatch {
+    mtx_t mtx;
+    _Atomic uint64_t version;
+    gab_value pending;
+    struct gab_dispatch_table *_Atomic table;
+    struct gab_dispatch_table *reclaim;
+  } dispatch;
 
   mtx_t shapes_mtx;
   gab_value shapes;
 
-  mtx_t strings_mtx;
-  d_strings strings;
+  /*
+   * The string intern table, split into shards by hash. A shard's table
+   * doesn't hold references to its strings - they remove themselves when
+   * they die.
+   */
+  struct gab_strshard {
+    mtx_t mtx;
+    d_strings strings;
+  } strings[cGAB_STRING_SHARDS];
 
   mtx_t sources_mtx;
   d_gab_src sources;
@@ -2388,20 +3114,87 @@ struct gab_eg {
 
   gab_osdynmod_load os_dynmod;
 
-  struct gab_obj *(*os_objalloc)(struct gab_triple gab, struct gab_obj *,
-                                 uint64_t new_size);
+  const char *cache;
+
+  gab_osobjalloc os_objalloc;
+  void *os_objalloc_ctx;
+
+  struct gab_obj *(*objalloc)(struct gab_triple gab, struct gab_obj *,
+                              uint64_t new_size);
 
   uint64_t len;
   struct gab_jb {
     thrd_t td;
 
-    bool alive;
+    _Atomic bool alive;
 
     gab_value fiber;
 
+    /*
+     * Fibers which haven't started yet. The job pushes and pops its own
+     * fibers at the bottom, while idle jobs steal from the top.
+     */
+    struct gab_deque {
+      _Atomic int64_t top, bottom;
+      struct gab_dequebuf {
+        int64_t cap;
+        struct gab_dequebuf *retired;
+        _Atomic gab_value data[];
+      } *_Atomic buf;
+    } deque;
+
+    /*
+     * Fibers this job has scheduled, and fibers it has finished. Each is
+     * only written by the job itself. Across every job, the totals match
+     * once there is no more work to do.
+     */
+    _Atomic uint64_t nscheduled, nfinished;
+
     _Atomic uint32_t epoch;
     _Atomic int32_t locked;
     v_gab_value lock_keep;
+
+    /*
+     * The job sleeps here when it has nothing to do. It is woken when work
+     * is queued, and by the gc when its epoch is scheduled.
+     */
+    struct gab_parker parker;
+
+    /*
+     * Fibers parked on a channel by this job, until they run again. They
+     * wait in line on the channel, and any job may resume them - this list
+     * only lets gab_destroy release the ones which are never woken.
+     */
+    struct {
+      mtx_t mtx;
+      struct gab_obj_fiber *head;
+    } parked;
+
+    /*
+     * Lookup cache shared by every megamorphic send this job runs.
+     * Entries are only valid for the messages record (and dispatch version)
+     * they were resolved under.
+     */
+    struct gab_sendcache {
+      uint64_t version;
+      gab_value messages, message, type, specs;
+      struct gab_impl_rest res;
+    } sendcache[cGAB_SEND_MEGACACHE_LEN];
+
+    /*
+     * Strings this job interned during the epoch strcache_epoch. Each holds a
+     * reference which is let go of with that epoch's decrements, so entries
+     * stay alive for as long as the job's epoch hasn't moved on.
+     */
+    uint32_t strcache_epoch;
+    struct gab_obj_string *strcache[cGAB_STRING_CACHE_LEN];
+
+    /*
+     * Slabs this job allocates objects from. Only the job itself allocates
+     * from them - objects freed by the gc job are handed back through each
+     * slab's remote list.
+     */
+    struct gab_slabs slabs;
   } jobs[];
 };
 
@@ -2571,9 +3364,78 @@ static inline gab_value gab_thisfibmsgrec(struct gab_triple gab,
   return gab_recat(gab_thisfibmsg(gab), message);
 }
 
+static inline uint64_t gab_dispatchhash(gab_value message,
+                                        gab_value receiver) {
+  uint64_t h = message * 0x9e3779b97f4a7c15 ^ receiver * 0xc2b2ae3d27d4eb4f;
+  return h ^ (h >> 32);
+}
+
+/**
+ * @brief Find the specialization of a message for a receiver in the engine's
+ * dispatch index.
+ *
+ * @param eg The engine
+ * @param messages The messages record to look in
+ * @param message The message
+ * @param receiver The receiver type
+ * @param spec Set to the specialization, or gab_undefined if there is none.
+ * @return False if the index doesn't mirror 'messages' right now.
+ */
+static inline bool gab_egdispatchat(struct gab_eg *eg, gab_value messages,
+                                    gab_value message, gab_value receiver,
+                                    gab_value *spec) {
+  struct gab_dispatch_table *t =
+      atomic_load_explicit(&eg->dispatch.table, memory_order_acquire);
+
+  uint64_t seq = atomic_load_explicit(&t->seq, memory_order_acquire);
+
+  if (seq & 1)
+    return false;
+
+  if (atomic_load_explicit(&t->messages, memory_order_acquire) != messages)
+    return false;
+
+  uint64_t mask = t->cap - 1;
+  uint64_t i = gab_dispatchhash(message, receiver) & mask;
+  gab_value found = gab_undefined;
+
+  for (;;) {
+    struct gab_dispatch_slot *slot = t->data + i;
+
+    gab_value m = atomic_load_explicit(&slot->message, memory_order_acquire);
+
+    if (m == 0)
+      break;
+
+    if (m == message &&
+        atomic_load_explicit(&slot->receiver, memory_order_relaxed) ==
+            receiver) {
+      found = atomic_load_explicit(&slot->spec, memory_order_acquire);
+      break;
+    }
+
+    i = (i + 1) & mask;
+  }
+
+  atomic_thread_fence(memory_order_acquire);
+
+  if (atomic_load_explicit(&t->seq, memory_order_relaxed) != seq)
+    return false;
+
+  *spec = found;
+  return true;
+}
+
 static inline gab_value
 gab_thisfibmsgat(struct gab_triple gab, gab_value message, gab_value receiver) {
-  gab_value spec_rec = gab_thisfibmsgrec(gab, message);
+  gab_value messages = gab_thisfibmsg(gab);
+
+  // Tables are only reclaimed across job epochs, so only jobs may use them.
+  gab_value spec;
+  if (gab.wkid && gab_egdispatchat(gab.eg, messages, message, receiver, &spec))
+    return spec;
+
+  gab_value spec_rec = gab_recat(messages, message);
 
   if (spec_rec == gab_undefined)
     return gab_undefined;
@@ -3,8 +3,11 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 // https://github.com/amakukha/minimal_hashes
+// This is stable across runs and machines, so it is used for anything that is
+// written to disk. Use hash_bytes for everything else.
 static inline uint64_t FNV1a_64(const uint8_t *data, size_t size) {
   uint64_t h = 0xcbf29ce484222325UL;
   for (uint64_t i = 0; i < size; i++) {
@@ -14,7 +17,101 @@ static inline uint64_t FNV1a_64(const uint8_t *data, size_t size) {
   return h;
 }
 
-static inline uint64_t hash_bytes(uint64_t len, uint8_t *bytes) {
-  return FNV1a_64(bytes, len * sizeof(uint8_t));
+/*
+ * wyhash (final version 4), from https://github.com/wangyi-fudan/wyhash,
+ * which is released into the public domain.
+ *
+ * It reads eight bytes at a time, and folds them in with a 64x64->128 bit
+ * multiply. Lengths up to 16 bytes are handled without a loop.
+ */
+static const uint64_t wyhash_secret[4] = {
+    0x2d358dccaa6c78a5ull,
+    0x8bb84b93962eacc9ull,
+    0x4b33a62ed433d4a3ull,
+    0x4d5a2da51de1aa47ull,
+};
+
+static inline uint64_t wyhash_mix(uint64_t a, uint64_t b) {
+  __uint128_t r = (__uint128_t)a * b;
+  return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
+
+static inline uint64_t wyhash_r8(const uint8_t *p) {
+  uint64_t v;
+  memcpy(&v, p, 8);
+  return v;
+}
+
+static inline uint64_t wyhash_r4(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, 4);
+  return v;
+}
+
+static inline uint64_t wyhash_r3(const uint8_t *p, size_t k) {
+  return ((uint64_t)p[0] << 16) | ((uint64_t)p[k >> 1] << 8) | p[k - 1];
+}
+
+static inline uint64_t wyhash(const uint8_t *p, size_t len, uint64_t seed) {
+  const uint64_t *s = wyhash_secret;
+  seed ^= wyhash_mix(seed ^ s[0], s[1]);
+
+  uint64_t a, b;
+
+  if (len <= 16) {
+    if (len >= 4) {
+      a = (wyhash_r4(p) << 32) | wyhash_r4(p + ((len >> 3) << 2));
+      b = (wyhash_r4(p + len - 4) << 32) |
+          wyhash_r4(p + len - 4 - ((len >> 3) << 2));
+    } else if (len > 0) {
+      a = wyhash_r3(p, len);
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t i = len;
+
+    if (i > 48) {
+      uint64_t see1 = seed, see2 = seed;
+
+      do {
+        seed = wyhash_mix(wyhash_r8(p) ^ s[1], wyhash_r8(p + 8) ^ seed);
+        see1 = wyhash_mix(wyhash_r8(p + 16) ^ s[2], wyhash_r8(p + 24) ^ see1);
+        see2 = wyhash_mix(wyhash_r8(p + 32) ^ s[3], wyhash_r8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+
+      seed ^= see1 ^ see2;
+    }
+
+    while (i > 16) {
+      seed = wyhash_mix(wyhash_r8(p) ^ s[1], wyhash_r8(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+
+    a = wyhash_r8(p + i - 16);
+    b = wyhash_r8(p + i - 8);
+  }
+
+  a ^= s[1];
+  b ^= seed;
+
+  __uint128_t r = (__uint128_t)a * b;
+  a = (uint64_t)r;
+  b = (uint64_t)(r >> 64);
+
+  return wyhash_mix(a ^ s[0] ^ len, b ^ s[1]);
+}
+
+/*
+ * Hash bytes for an in-memory table. The seed should be random per process
+ * (see gab_eg.hash_seed), so hashes must never be saved.
+ */
+static inline uint64_t hash_bytes(uint64_t seed, uint64_t len,
+                                  const uint8_t *bytes) {
+  return wyhash(bytes, len, seed);
 }
 #endif
@@ -24,11 +24,14 @@
 #include <unistd.h>
 
 #define gab_fisatty(f) isatty(fileno(f))
+#define gab_osgetpid() getpid()
 
 #elifdef GAB_PLATFORM_WIN
 #include <io.h>
+#include <process.h>
 
 #define gab_fisatty(f) _isatty(_fileno(f))
+#define gab_osgetpid() _getpid()
 
 #endif
 
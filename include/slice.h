@@ -33,7 +33,7 @@ LINKAGE bool METHOD(match)(TYPENAME self, TYPENAME other) {
 }
 
 LINKAGE size_t METHOD(hash)(TYPENAME self) {
-  return hash_bytes(self.len * sizeof(T), (uint8_t *)self.data);
+  return hash_bytes(0, self.len * sizeof(T), (uint8_t *)self.data);
 }
 
 #undef T
@@ -745,24 +745,529 @@ void gab_yield(struct gab_triple gab) {
   thrd_yield();
 }
 
+void gab_parkercreate(struct gab_parker *p) {
+  mtx_init(&p->mtx, mtx_plain);
+  cnd_init(&p->cnd);
+  p->signaled = false;
+  p->sleeping = false;
+  p->nsleeps = 0;
+}
+
+void gab_parkerdestroy(struct gab_parker *p) {
+  cnd_destroy(&p->cnd);
+  mtx_destroy(&p->mtx);
+}
+
+/*
+ * The main thread (and any other thread driving the engine from outside)
+ * isn't a job, so it doesn't own a parker in eg->jobs.
+ */
+static thread_local struct gab_parker main_parker;
+static thread_local bool main_parker_init = false;
+
+struct gab_parker *gab_thisparker(struct gab_triple gab) {
+  if (gab.wkid)
+    return &gab.eg->jobs[gab.wkid].parker;
+
+  if (!main_parker_init) {
+    gab_parkercreate(&main_parker);
+    main_parker_init = true;
+  }
+
+  return &main_parker;
+}
+
+bool gab_park(struct gab_parker *p, uint64_t timeout_ns) {
+  mtx_lock(&p->mtx);
+
+  if (!p->signaled) {
+    p->sleeping = true;
+    p->nsleeps++;
+
+    if (timeout_ns == (uint64_t)-1) {
+      cnd_wait(&p->cnd, &p->mtx);
+    } else {
+      struct timespec deadline;
+      timespec_get(&deadline, TIME_UTC);
+
+      uint64_t ns = deadline.tv_nsec + timeout_ns % 1000000000;
+      deadline.tv_sec += timeout_ns / 1000000000 + ns / 1000000000;
+      deadline.tv_nsec = ns % 1000000000;
+
+      cnd_timedwait(&p->cnd, &p->mtx, &deadline);
+    }
+
+    p->sleeping = false;
+  }
+
+  bool signaled = p->signaled;
+  p->signaled = false;
+
+  mtx_unlock(&p->mtx);
+  return signaled;
+}
+
+void gab_unpark(struct gab_parker *p) {
+  mtx_lock(&p->mtx);
+  p->signaled = true;
+  cnd_signal(&p->cnd);
+  mtx_unlock(&p->mtx);
+}
+
+void gab_wlcreate(struct gab_waitlist *wl) {
+  mtx_init(&wl->mtx, mtx_plain);
+  wl->len = 0;
+  wl->seq = 0;
+  v_gab_parker_create(&wl->parkers, 1);
+}
+
+void gab_wldestroy(struct gab_waitlist *wl) {
+  assert(wl->len == 0);
+  v_gab_parker_destroy(&wl->parkers);
+  mtx_destroy(&wl->mtx);
+}
+
+void gab_wladd(struct gab_waitlist *wl, struct gab_parker *p) {
+  mtx_lock(&wl->mtx);
+  v_gab_parker_push(&wl->parkers, p);
+  wl->len = wl->parkers.len;
+  mtx_unlock(&wl->mtx);
+}
+
+void gab_wlremove(struct gab_waitlist *wl, struct gab_parker *p) {
+  mtx_lock(&wl->mtx);
+
+  for (uint64_t i = 0; i < wl->parkers.len; i++) {
+    if (wl->parkers.data[i] == p) {
+      wl->parkers.data[i] = wl->parkers.data[--wl->parkers.len];
+      break;
+    }
+  }
+
+  wl->len = wl->parkers.len;
+  mtx_unlock(&wl->mtx);
+}
+
+void gab_wlnotify(struct gab_waitlist *wl) {
+  // Bumping seq orders this notify after the state change. A waiter which
+  // checked its condition too early will either see the new seq, or be
+  // in the list by the time we read len.
+  atomic_fetch_add(&wl->seq, 1);
+
+  if (!wl->len)
+    return;
+
+  mtx_lock(&wl->mtx);
+
+  for (uint64_t i = 0; i < wl->parkers.len; i++)
+    gab_unpark(wl->parkers.data[i]);
+
+  wl->parkers.len = 0;
+  wl->len = 0;
+
+  mtx_unlock(&wl->mtx);
+}
+
+void gab_wlnotifyone(struct gab_waitlist *wl) {
+  // As in gab_wlnotify. Each waiter re-checks its condition once woken, and
+  // keeps waiting if someone else got there first.
+  atomic_fetch_add(&wl->seq, 1);
+
+  if (!wl->len)
+    return;
+
+  mtx_lock(&wl->mtx);
+
+  if (wl->parkers.len)
+    gab_unpark(v_gab_parker_pop(&wl->parkers));
+
+  wl->len = wl->parkers.len;
+
+  mtx_unlock(&wl->mtx);
+}
+
+uint64_t gab_wlkey(struct gab_waitlist *wl) { return wl->seq; }
+
+bool gab_wlwait(struct gab_triple gab, struct gab_waitlist *wl, uint64_t key,
+                uint64_t timeout_ns) {
+  struct gab_parker *p = gab_thisparker(gab);
+
+  gab_wladd(wl, p);
+
+  bool woken = true;
+  if (wl->seq == key)
+    woken = gab_park(p, timeout_ns);
+
+  gab_wlremove(wl, p);
+
+  // We may have been woken to do our part of a collection.
+  if (gab.wkid && gab.eg->gc->schedule == gab.wkid)
+    gab_gcepochnext(gab);
+
+  return woken;
+}
+
 int32_t gc_job(void *data) {
   struct gab_triple *g = data;
   struct gab_triple gab = *g;
   assert(gab.wkid == 0);
 
   gab.eg->jobs[gab.wkid].fiber = gab_undefined;
+  gab_slabsown(&gab.eg->gcslabs);
 
   while (gab.eg->njobs >= 0) {
     if (gab.eg->gc->schedule == gab.wkid)
       gab_gcdocollect(gab);
 
-    gab_yield(gab);
+    // Free what the collection left dead a slice at a time, until it's our
+    // turn to collect again.
+    while (gab.eg->gc->schedule != gab.wkid && gab_gcsweep(gab))
+      ;
+
+    if (gab.eg->gc->schedule == gab.wkid)
+      continue;
+
+    // schedule() wakes us when it's our turn to collect.
+    gab_park(&gab.eg->jobs[gab.wkid].parker, (uint64_t)-1);
   }
 
   free(g);
   return 0;
 }
 
+static struct gab_dequebuf *dequebuf(int64_t cap) {
+  assert((cap & (cap - 1)) == 0);
+
+  struct gab_dequebuf *b =
+      malloc(sizeof(struct gab_dequebuf) + sizeof(gab_value) * cap);
+
+  b->cap = cap;
+  b->retired = nullptr;
+  return b;
+}
+
+static void deque_create(struct gab_deque *q) {
+  q->top = 0;
+  q->bottom = 0;
+  q->buf = dequebuf(cGAB_WORKER_DEQUE_INITIAL_CAP);
+}
+
+static void deque_destroy(struct gab_deque *q) {
+  struct gab_dequebuf *b = q->buf;
+  while (b) {
+    struct gab_dequebuf *retired = b->retired;
+    free(b);
+    b = retired;
+  }
+}
+
+static bool deque_isempty(struct gab_deque *q) {
+  return atomic_load_explicit(&q->bottom, memory_order_acquire) <=
+         atomic_load_explicit(&q->top, memory_order_acquire);
+}
+
+/*
+ * Only the owning job may push. When the buffer is full it is doubled, and
+ * the old one is kept around - a thief may still be reading from it.
+ */
+static void deque_push(struct gab_deque *q, gab_value fiber) {
+  int64_t b = atomic_load_explicit(&q->bottom, memory_order_relaxed);
+  int64_t t = atomic_load_explicit(&q->top, memory_order_acquire);
+  struct gab_dequebuf *a = atomic_load_explicit(&q->buf, memory_order_relaxed);
+
+  if (b - t > a->cap - 1) {
+    struct gab_dequebuf *grown = dequebuf(a->cap * 2);
+
+    for (int64_t i = t; i < b; i++)
+      grown->data[i & (grown->cap - 1)] = a->data[i & (a->cap - 1)];
+
+    grown->retired = a;
+    atomic_store_explicit(&q->buf, grown, memory_order_release);
+    a = grown;
+  }
+
+  atomic_store_explicit(&a->data[b & (a->cap - 1)], fiber,
+                        memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+}
+
+/*
+ * Only the owning job may pop. It takes its newest fiber, which is the
+ * most likely to still be in cache.
+ */
+static gab_value deque_pop(struct gab_deque *q) {
+  int64_t b = atomic_load_explicit(&q->bottom, memory_order_relaxed) - 1;
+  struct gab_dequebuf *a = atomic_load_explicit(&q->buf, memory_order_relaxed);
+  atomic_store_explicit(&q->bottom, b, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  int64_t t = atomic_load_explicit(&q->top, memory_order_relaxed);
+
+  if (t > b) {
+    atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+    return gab_undefined;
+  }
+
+  gab_value fiber =
+      atomic_load_explicit(&a->data[b & (a->cap - 1)], memory_order_relaxed);
+
+  // This is the last fiber - race any thieves for it.
+  if (t == b) {
+    if (!atomic_compare_exchange_strong_explicit(&q->top, &t, t + 1,
+                                                 memory_order_seq_cst,
+                                                 memory_order_relaxed))
+      fiber = gab_undefined;
+
+    atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+  }
+
+  return fiber;
+}
+
+/*
+ * Steal the oldest fiber from another job's deque. Returns gab_undefined if
+ * the deque is empty, or another job won the race for it.
+ */
+static gab_value deque_steal(struct gab_deque *q) {
+  int64_t t = atomic_load_explicit(&q->top, memory_order_acquire);
+  atomic_thread_fence(memory_order_seq_cst);
+  int64_t b = atomic_load_explicit(&q->bottom, memory_order_acquire);
+
+  if (t >= b)
+    return gab_undefined;
+
+  struct gab_dequebuf *a = atomic_load_explicit(&q->buf, memory_order_acquire);
+  gab_value fiber =
+      atomic_load_explicit(&a->data[t & (a->cap - 1)], memory_order_relaxed);
+
+  if (!atomic_compare_exchange_strong_explicit(&q->top, &t, t + 1,
+                                               memory_order_seq_cst,
+                                               memory_order_relaxed))
+    return gab_undefined;
+
+  return fiber;
+}
+
+static void inject_push(struct gab_inject *q, gab_value fiber) {
+  mtx_lock(&q->mtx);
+  v_gab_value_push(&q->fibers, fiber);
+  q->len++;
+  mtx_unlock(&q->mtx);
+}
+
+static gab_value inject_take(struct gab_inject *q) {
+  if (!q->len)
+    return gab_undefined;
+
+  gab_value fiber = gab_undefined;
+
+  mtx_lock(&q->mtx);
+
+  if (q->len) {
+    fiber = q->fibers.data[q->head++];
+    q->len--;
+
+    if (!q->len)
+      q->head = q->fibers.len = 0;
+  }
+
+  mtx_unlock(&q->mtx);
+  return fiber;
+}
+
+/*
+ * Return true once every fiber which was ever scheduled has finished.
+ *
+ * A fiber can only finish after it was scheduled, so the finished counts
+ * are summed first. If the totals still match, nothing was running in
+ * between - and nothing is left to schedule more work.
+ */
+static bool all_fibers_done(struct gab_eg *eg) {
+  uint64_t finished = 0, scheduled = 0;
+
+  for (uint64_t i = 0; i < eg->len; i++)
+    finished += eg->jobs[i].nfinished;
+
+  for (uint64_t i = 0; i < eg->len; i++)
+    scheduled += eg->jobs[i].nscheduled;
+
+  return finished == scheduled;
+}
+
+static bool parker_isasleep(struct gab_parker *p, uint64_t *nsleeps) {
+  mtx_lock(&p->mtx);
+
+  bool asleep = p->sleeping && !p->signaled;
+  *nsleeps = p->nsleeps;
+
+  mtx_unlock(&p->mtx);
+  return asleep;
+}
+
+/*
+ * Return true if every job is asleep with nothing to run. Each one is
+ * checked twice - if none of them woke up in between, then at that moment
+ * there was nobody left who could wake them. The remaining fibers are
+ * deadlocked.
+ */
+static bool all_jobs_stuck(struct gab_eg *eg) {
+  uint64_t before[eg->len], after[eg->len];
+
+  for (uint64_t i = 1; i < eg->len; i++)
+    if (eg->jobs[i].alive && !parker_isasleep(&eg->jobs[i].parker, before + i))
+      return false;
+
+  if (eg->inject.len)
+    return false;
+
+  for (uint64_t i = 1; i < eg->len; i++)
+    if (!deque_isempty(&eg->jobs[i].deque))
+      return false;
+
+  for (uint64_t i = 1; i < eg->len; i++) {
+    if (!eg->jobs[i].alive)
+      continue;
+
+    if (!parker_isasleep(&eg->jobs[i].parker, after + i))
+      return false;
+
+    if (before[i] != after[i])
+      return false;
+  }
+
+  return true;
+}
+
+/*
+ * While a fiber is parked, it isn't the job's running fiber - so the gc
+ * doesn't see its stack. Hold references to everything on it instead, until
+ * it runs again.
+ */
+static void fiber_park(struct gab_triple gab, gab_value f) {
+  struct gab_obj_fiber *fiber = GAB_VAL_TO_FIBER(f);
+  struct gab_jb *wk = gab.eg->jobs + gab.wkid;
+
+  gab_iref(gab, f);
+  gab_iref(gab, fiber->messages);
+  gab_niref(gab, 1, fiber->vm.sp - fiber->vm.sb, fiber->vm.sb);
+
+  mtx_lock(&wk->parked.mtx);
+
+  fiber->parked_prev = nullptr;
+  fiber->parked_next = wk->parked.head;
+
+  if (wk->parked.head)
+    wk->parked.head->parked_prev = fiber;
+
+  wk->parked.head = fiber;
+
+  mtx_unlock(&wk->parked.mtx);
+
+  gab_chnpark(gab, f);
+}
+
+static void fiber_unpark(struct gab_triple gab, gab_value f) {
+  struct gab_obj_fiber *fiber = GAB_VAL_TO_FIBER(f);
+  struct gab_jb *wk = gab.eg->jobs + fiber->vm.wkid;
+
+  mtx_lock(&wk->parked.mtx);
+
+  if (fiber->parked_prev)
+    fiber->parked_prev->parked_next = fiber->parked_next;
+  else
+    wk->parked.head = fiber->parked_next;
+
+  if (fiber->parked_next)
+    fiber->parked_next->parked_prev = fiber->parked_prev;
+
+  mtx_unlock(&wk->parked.mtx);
+
+  gab_ndref(gab, 1, fiber->vm.sp - fiber->vm.sb, fiber->vm.sb);
+  gab_dref(gab, fiber->messages);
+  gab_dref(gab, f);
+}
+
+static void worker_run(struct gab_triple gab, gab_value fiber) {
+  gab.eg->jobs[gab.wkid].fiber = fiber;
+
+  gab_vmexec(gab, fiber);
+
+  // The fiber didn't finish, it parked on a channel.
+  if (gab_valkind(fiber) == kGAB_FIBERRUNNING) {
+    fiber_park(gab, fiber);
+  } else {
+    gab.eg->jobs[gab.wkid].nfinished++;
+    gab_wlnotify(&GAB_VAL_TO_FIBER(fiber)->waiters);
+  }
+
+  gab.eg->jobs[gab.wkid].fiber = gab_undefined;
+}
+
+/*
+ * Find a fiber to run - one which hasn't started yet, or a parked one which
+ * is ready again. Prefer our own, then those scheduled from outside, and
+ * finally steal from another job.
+ */
+static gab_value worker_next(struct gab_triple gab) {
+  struct gab_eg *eg = gab.eg;
+
+  gab_value fiber = deque_pop(&eg->jobs[gab.wkid].deque);
+  if (fiber != gab_undefined)
+    return fiber;
+
+  fiber = inject_take(&eg->inject);
+  if (fiber != gab_undefined)
+    return fiber;
+
+  for (uint64_t i = 1; i < eg->len; i++) {
+    uint64_t victim = 1 + (gab.wkid - 1 + i) % (eg->len - 1);
+
+    if (victim == gab.wkid)
+      continue;
+
+    fiber = deque_steal(&eg->jobs[victim].deque);
+    if (fiber != gab_undefined)
+      return fiber;
+  }
+
+  return gab_undefined;
+}
+
+static bool worker_hasnext(struct gab_triple gab) {
+  if (gab.eg->inject.len)
+    return true;
+
+  for (uint64_t i = 1; i < gab.eg->len; i++)
+    if (!deque_isempty(&gab.eg->jobs[i].deque))
+      return true;
+
+  return false;
+}
+
+/*
+ * Sleep until new work is scheduled. Returns false if we timed out.
+ */
+static bool worker_idle(struct gab_triple gab) {
+  struct gab_jb *wk = gab.eg->jobs + gab.wkid;
+
+  gab_wladd(&gab.eg->idle, &wk->parker);
+
+  // gab_destroy may be waiting for every job to run out of work.
+  gab_wlnotify(&gab.eg->lifecycle);
+
+  // Now that we're on the waitlist, check again before sleeping.
+  bool woken = true;
+  if (!gab.eg->shutdown && !worker_hasnext(gab))
+    woken = gab_park(&wk->parker, cGAB_WORKER_IDLEWAIT_MS * 1000000);
+
+  gab_wlremove(&gab.eg->idle, &wk->parker);
+
+  if (gab.eg->gc->schedule == gab.wkid)
+    gab_gcepochnext(gab);
+
+  return woken;
+}
+
 int32_t worker_job(void *data) {
   struct gab_triple *g = data;
   struct gab_triple gab = *g;
@@ -770,47 +1275,66 @@ int32_t worker_job(void *data) {
   assert(gab.wkid != 0);
   gab.eg->njobs++;
 
+  struct gab_jb *wk = gab.eg->jobs + gab.wkid;
+
 #if cGAB_LOG_EG
   fprintf(stdout, "[WORKER %i] SPAWNED\n", gab.wkid);
 #endif
 
-  while (!gab_chnisclosed(gab.eg->work_channel) ||
-         !gab_chnisempty(gab.eg->work_channel)) {
+  for (;;) {
+    gab_value fiber = worker_next(gab);
 
 #if cGAB_LOG_EG
-    fprintf(stdout, "[WORKER %i] TAKING WITH TIMEOUT %lus\n", gab.wkid,
-            cGAB_WORKER_IDLEWAIT_MS / 1000);
+    fprintf(stdout, "[WORKER %i] next yielded: ", gab.wkid);
+    gab_fprintf(stdout, "$\n", fiber);
 #endif
 
-    gab_value fiber = gab_tchntake(gab, gab.eg->work_channel, cGAB_WORKER_IDLEWAIT_MS);
+    if (fiber != gab_undefined) {
+      // Now that the fiber is running here, the gc can see it. The references
+      // held while it was waiting to be run are no longer needed.
+      wk->fiber = fiber;
 
-#if cGAB_LOG_EG
-    fprintf(stdout, "[WORKER %i] chntake yielded: ", gab.wkid);
-    gab_fprintf(stdout, "$\n", fiber);
-#endif
+      if (gab_valkind(fiber) == kGAB_FIBERRUNNING)
+        fiber_unpark(gab, fiber);
+      else
+        gab_dref(gab, fiber);
 
-    // we get undefined if:
-    //  - the channel is closed
-    //  - we timed out
-    if (fiber == gab_undefined)
-      break;
+      worker_run(gab, fiber);
+      continue;
+    }
+
+    // Nothing could make progress, so sleep until something changes.
+    bool woken = worker_idle(gab);
+
+    bool shutdown = gab.eg->shutdown && !worker_hasnext(gab);
+
+    if (woken && !shutdown)
+      continue;
 
-    gab.eg->jobs[gab.wkid].fiber = fiber;
+    // We're done. Before exiting, make sure nobody counted on us in the
+    // meantime: the gc may have scheduled our epoch, or work may have been
+    // scheduled from outside. Then revive, unless another job already has.
+    wk->alive = false;
 
-    gab_vmexec(gab, fiber);
+    bool needed = gab.eg->gc->schedule == gab.wkid ||
+                  (!shutdown && gab.eg->inject.len);
 
-    gab.eg->jobs[gab.wkid].fiber = gab_undefined;
+    bool dead = false;
+    if (!needed || !atomic_compare_exchange_strong(&wk->alive, &dead, true))
+      break;
   }
 
 #if cGAB_LOG_EG
   fprintf(stdout, "[WORKER %i] CLOSING\n", gab.wkid);
 #endif
 
-  gab.eg->jobs[gab.wkid].alive = false;
-  gab.eg->jobs[gab.wkid].fiber = gab_undefined;
+  assert(wk->locked == 0);
+
+  // Don't touch the job after this point. Once it isn't alive, it can be
+  // revived by another thread.
   gab.eg->njobs--;
 
-  assert(gab.eg->jobs[gab.wkid].locked == 0);
+  gab_wlnotify(&gab.eg->lifecycle);
 
   free(g);
 
@@ -834,13 +1358,17 @@ bool gab_jbcreate(struct gab_triple gab, struct gab_jb *job, int(fn)(void *)) {
   if (!job)
     return false;
 
+  // Another thread may be reviving the same job.
+  bool dead = false;
+  if (!atomic_compare_exchange_strong(&job->alive, &dead, true))
+    return false;
+
 #if cGAB_LOG_EG
   fprintf(stdout, "[WORKER %i] spawning %lu\n", gab.wkid, job - gab.eg->jobs);
 #endif
 
   job->locked = 0;
   job->fiber = gab_undefined;
-  job->alive = true;
   v_gab_value_create(&job->lock_keep, 8);
 
   struct gab_triple *gabcpy = malloc(sizeof(struct gab_triple));
@@ -861,6 +1389,201 @@ bool gab_wkspawn(struct gab_triple gab) {
   return gab_jbcreate(gab, next_available_job(gab), worker_job);
 }
 
+/*
+ * Put a fiber in line to be run by some job. From inside a job, the fiber
+ * goes onto the job's own deque. From outside, it is injected for any job to
+ * take.
+ */
+static void fiber_enqueue(struct gab_triple gab, gab_value fb) {
+  if (gab.wkid)
+    deque_push(&gab.eg->jobs[gab.wkid].deque, fb);
+  else
+    inject_push(&gab.eg->inject, fb);
+
+  // Grow the pool of jobs, if there is room.
+  gab_wkspawn(gab);
+
+  // Pairs with the re-check in worker_idle: either an idle job sees our
+  // fiber, or we see it waiting. One job is enough to run it.
+  atomic_thread_fence(memory_order_seq_cst);
+  if (gab.eg->idle.len)
+    gab_wlnotifyone(&gab.eg->idle);
+}
+
+static void fiber_schedule(struct gab_triple gab, gab_value fb) {
+  // The fiber isn't reachable from any stack while it waits to be run.
+  gab_iref(gab, fb);
+
+  gab.eg->jobs[gab.wkid].nscheduled++;
+
+  fiber_enqueue(gab, fb);
+}
+
+void gab_fibresume(struct gab_triple gab, gab_value fb) {
+  // The references taken when it parked keep it alive until it runs.
+  assert(gab_valkind(fb) == kGAB_FIBERRUNNING);
+  fiber_enqueue(gab, fb);
+}
+
+static struct gab_dispatch_table *dispatch_table(gab_value messages,
+                                                 uint64_t cap) {
+  assert((cap & (cap - 1)) == 0);
+
+  struct gab_dispatch_table *t =
+      calloc(1, sizeof(struct gab_dispatch_table) +
+                    sizeof(struct gab_dispatch_slot) * cap);
+
+  t->cap = cap;
+  t->messages = messages;
+  return t;
+}
+
+static void dispatch_put(struct gab_dispatch_table *t, gab_value message,
+                         gab_value receiver, gab_value spec) {
+  uint64_t mask = t->cap - 1;
+  uint64_t i = gab_dispatchhash(message, receiver) & mask;
+
+  for (;;) {
+    struct gab_dispatch_slot *slot = t->data + i;
+
+    gab_value m = atomic_load_explicit(&slot->message, memory_order_relaxed);
+
+    if (m == 0) {
+      // Fill in the rest of the slot *before* publishing its message,
+      // so that a reader who sees the message sees the whole slot.
+      atomic_store_explicit(&slot->receiver, receiver, memory_order_relaxed);
+      atomic_store_explicit(&slot->spec, spec, memory_order_relaxed);
+      atomic_store_explicit(&slot->message, message, memory_order_release);
+      t->len++;
+      return;
+    }
+
+    if (m == message &&
+        atomic_load_explicit(&slot->receiver, memory_order_relaxed) ==
+            receiver) {
+      atomic_store_explicit(&slot->spec, spec, memory_order_release);
+      return;
+    }
+
+    i = (i + 1) & mask;
+  }
+}
+
+static void dispatch_publish(struct gab_eg *eg, struct gab_dispatch_table *t) {
+  t->retired = eg->dispatch.table;
+  atomic_store_explicit(&eg->dispatch.table, t, memory_order_release);
+}
+
+/*
+ * Make sure there is room for n more slots in the dispatch index, growing it
+ * if necessary. Grown tables are published for readers immediately.
+ */
+static struct gab_dispatch_table *dispatch_reserve(struct gab_eg *eg,
+                                                   uint64_t n) {
+  struct gab_dispatch_table *t = eg->dispatch.table;
+
+  if (t->len + n < t->cap * cGAB_DICT_MAX_LOAD)
+    return t;
+
+  uint64_t cap = t->cap;
+  while (t->len + n >= cap * cGAB_DICT_MAX_LOAD)
+    cap <<= 1;
+
+  struct gab_dispatch_table *nt = dispatch_table(t->messages, cap);
+
+  for (uint64_t i = 0; i < t->cap; i++) {
+    struct gab_dispatch_slot *slot = t->data + i;
+    if (slot->message)
+      dispatch_put(nt, slot->message, slot->receiver, slot->spec);
+  }
+
+  dispatch_publish(eg, nt);
+  return nt;
+}
+
+/*
+ * Bring the dispatch index in sync with the messages record 'to', which was
+ * made by defining 'args' on top of the record 'from'.
+ *
+ * If the index mirrors 'from', the new specializations are added in place.
+ * Otherwise 'to' is left for the next collection to rebuild the index from.
+ */
+static void dispatch_sync(struct gab_eg *eg, gab_value from, gab_value to,
+                          uint64_t len, struct gab_def_argt args[len]) {
+  mtx_lock(&eg->dispatch.mtx);
+
+  struct gab_dispatch_table *t = eg->dispatch.table;
+
+  if (t->messages == from) {
+    t = dispatch_reserve(eg, len);
+
+    uint64_t seq = atomic_load_explicit(&t->seq, memory_order_relaxed);
+    atomic_store_explicit(&t->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    for (uint64_t i = 0; i < len; i++)
+      dispatch_put(t, args[i].message, args[i].receiver, args[i].specialization);
+
+    atomic_store_explicit(&t->messages, to, memory_order_relaxed);
+    atomic_store_explicit(&t->seq, seq + 2, memory_order_release);
+
+    eg->dispatch.pending = gab_undefined;
+  } else if (t->messages != to) {
+    eg->dispatch.pending = to;
+  }
+
+  atomic_fetch_add_explicit(&eg->dispatch.version, 1, memory_order_relaxed);
+  mtx_unlock(&eg->dispatch.mtx);
+}
+
+gab_value gab_dispatchepoch(struct gab_triple gab) {
+  struct gab_eg *eg = gab.eg;
+
+  mtx_lock(&eg->dispatch.mtx);
+
+  // Everything retired before the last collection is unreachable now.
+  struct gab_dispatch_table *t = eg->dispatch.reclaim;
+  while (t) {
+    struct gab_dispatch_table *retired = t->retired;
+    free(t);
+    t = retired;
+  }
+
+  gab_value to = eg->dispatch.pending;
+
+  if (to != gab_undefined) {
+    uint64_t n = 0;
+    for (uint64_t i = 0; i < gab_reclen(to); i++)
+      n += gab_reclen(gab_uvrecat(to, i));
+
+    uint64_t cap = cGAB_DISPATCH_INITIAL_CAP;
+    while (n >= cap * cGAB_DICT_MAX_LOAD)
+      cap <<= 1;
+
+    struct gab_dispatch_table *nt = dispatch_table(to, cap);
+
+    for (uint64_t i = 0; i < gab_reclen(to); i++) {
+      gab_value message = gab_ukrecat(to, i);
+      gab_value specs = gab_uvrecat(to, i);
+
+      for (uint64_t j = 0; j < gab_reclen(specs); j++)
+        dispatch_put(nt, message, gab_ukrecat(specs, j), gab_uvrecat(specs, j));
+    }
+
+    dispatch_publish(eg, nt);
+    eg->dispatch.pending = gab_undefined;
+  }
+
+  t = eg->dispatch.table;
+  eg->dispatch.reclaim = t->retired;
+  t->retired = nullptr;
+
+  gab_value mirrored = t->messages;
+
+  mtx_unlock(&eg->dispatch.mtx);
+  return mirrored;
+}
+
 struct gab_triple gab_create(struct gab_create_argt args) {
   uint64_t njobs = args.jobs ? args.jobs : 8;
 
@@ -876,14 +1599,31 @@ struct gab_triple gab_create(struct gab_create_argt args) {
   eg->len = njobs + 1;
   eg->njobs = 0;
   eg->os_dynmod = args.os_dynmod;
+  eg->cache = args.cache;
+  eg->os_objalloc = args.os_objalloc;
+  eg->os_objalloc_ctx = args.os_objalloc_ctx;
+  eg->objalloc = args.os_objalloc ? gab_hookalloc : gab_slaballoc;
   eg->hash_seed = time(nullptr);
   eg->sin = args.sin;
   eg->sout = args.sout;
   eg->serr = args.serr;
 
   // The only non-zero initialization that jobs need is epoch = 1
-  for (uint64_t i = 0; i < eg->len; i++)
+  for (uint64_t i = 0; i < eg->len; i++) {
     eg->jobs[i].epoch = 1;
+    gab_parkercreate(&eg->jobs[i].parker);
+    deque_create(&eg->jobs[i].deque);
+    mtx_init(&eg->jobs[i].parked.mtx, mtx_plain);
+    mtx_init(&eg->jobs[i].slabs.mtx, mtx_plain);
+  }
+
+  mtx_init(&eg->gcslabs.mtx, mtx_plain);
+
+  mtx_init(&eg->inject.mtx, mtx_plain);
+  v_gab_value_create(&eg->inject.fibers, 8);
+
+  gab_wlcreate(&eg->idle);
+  gab_wlcreate(&eg->lifecycle);
 
   assert(eg->sin);
   assert(eg->sout);
@@ -891,8 +1631,14 @@ struct gab_triple gab_create(struct gab_create_argt args) {
 
   mtx_init(&eg->shapes_mtx, mtx_plain);
   mtx_init(&eg->sources_mtx, mtx_plain);
-  mtx_init(&eg->strings_mtx, mtx_plain);
+  for (uint64_t i = 0; i < cGAB_STRING_SHARDS; i++)
+    mtx_init(&eg->strings[i].mtx, mtx_plain);
+
   mtx_init(&eg->modules_mtx, mtx_plain);
+  mtx_init(&eg->scratch_mtx, mtx_plain);
+  mtx_init(&eg->dispatch.mtx, mtx_plain);
+
+  eg->dispatch.pending = gab_undefined;
 
   d_gab_src_create(&eg->sources, 8);
 
@@ -911,8 +1657,8 @@ struct gab_triple gab_create(struct gab_create_argt args) {
 
   eg->shapes = __gab_shape(gab, 0);
   eg->messages = gab_erecord(gab);
-  eg->work_channel = gab_channel(gab);
-  gab_iref(gab, eg->work_channel);
+  eg->dispatch.table =
+      dispatch_table(eg->messages, cGAB_DISPATCH_INITIAL_CAP);
 
   eg->types[kGAB_UNDEFINED] = gab_undefined;
   eg->types[kGAB_NUMBER] = gab_string(gab, tGAB_NUMBER);
@@ -1008,35 +1754,64 @@ struct gab_triple gab_create(struct gab_create_argt args) {
   if (!(gab.flags & fGAB_ENV_EMPTY))
     gab_suse(gab, "core");
 
+  // Everything defined so far lives as long as the engine, as does every
+  // shape.
+  gab_gcimmortal(gab, 1, &eg->messages);
+  gab_gcimmortal(gab, 1, &eg->shapes);
+
   return gab_gcunlock(gab), gab;
 }
 
 void gab_destroy(struct gab_triple gab) {
   // Wait until there is no work to be done
-  while (!gab_chnisempty(gab.eg->work_channel))
-    ;
+  for (;;) {
+    uint64_t key = gab_wlkey(&gab.eg->lifecycle);
 
-  gab_chnclose(gab.eg->work_channel);
+    if (all_fibers_done(gab.eg) || all_jobs_stuck(gab.eg))
+      break;
 
-  while (gab.eg->njobs > 0)
-    continue;
+    // Jobs notify us just before they fall asleep, not after. So check back
+    // periodically to notice when they all have.
+    gab_wlwait(gab, &gab.eg->lifecycle, key,
+               cGAB_WORKER_IDLEWAIT_MS * 1000000);
+  }
 
-  gab_dref(gab, gab.eg->work_channel);
-  gab_ndref(gab, 1, gab.eg->scratch.len, gab.eg->scratch.data);
+  gab.eg->shutdown = true;
+  gab_wlnotify(&gab.eg->idle);
+
+  for (;;) {
+    uint64_t key = gab_wlkey(&gab.eg->lifecycle);
+
+    if (gab.eg->njobs <= 0)
+      break;
+
+    gab_wlwait(gab, &gab.eg->lifecycle, key, -1);
+  }
 
-  for (uint64_t i = 0; i < gab.eg->strings.cap; i++)
-    if (d_strings_iexists(&gab.eg->strings, i))
-      gab_dref(gab, __gab_obj(d_strings_ikey(&gab.eg->strings, i)));
+  // Fibers still parked are deadlocked - nothing is left to wake them.
+  for (uint64_t i = 1; i < gab.eg->len; i++)
+    while (gab.eg->jobs[i].parked.head)
+      fiber_unpark(gab, __gab_obj(gab.eg->jobs[i].parked.head));
+
+  gab_ndref(gab, 1, gab.eg->scratch.len, gab.eg->scratch.data);
 
   gab.eg->messages = gab_undefined;
   gab.eg->shapes = gab_undefined;
 
   gab_collect(gab);
-  while (gab.eg->gc->schedule >= 0)
-    ;
+
+  for (;;) {
+    uint64_t key = gab_wlkey(&gab.eg->lifecycle);
+
+    if (gab.eg->gc->schedule < 0)
+      break;
+
+    gab_wlwait(gab, &gab.eg->lifecycle, key, -1);
+  }
 
   gab.eg->njobs = -1;
 
+  gab_unpark(&gab.eg->jobs[0].parker);
   thrd_join(gab.eg->jobs[0].td, nullptr);
   gab_gcdestroy(gab);
   free(gab.eg->gc);
@@ -1058,18 +1833,46 @@ void gab_destroy(struct gab_triple gab) {
   for (int i = 0; i < gab.eg->len; i++) {
     struct gab_jb *wk = &gab.eg->jobs[i];
     v_gab_value_destroy(&wk->lock_keep);
+    mtx_destroy(&wk->parked.mtx);
+    gab_parkerdestroy(&wk->parker);
+    deque_destroy(&wk->deque);
   }
 
-  d_strings_destroy(&gab.eg->strings);
+  v_gab_value_destroy(&gab.eg->inject.fibers);
+  mtx_destroy(&gab.eg->inject.mtx);
+
+  gab_wldestroy(&gab.eg->idle);
+  gab_wldestroy(&gab.eg->lifecycle);
+
+  for (uint64_t i = 0; i < cGAB_STRING_SHARDS; i++)
+    d_strings_destroy(&gab.eg->strings[i].strings);
+
   d_gab_modules_destroy(&gab.eg->modules);
   d_gab_src_destroy(&gab.eg->sources);
 
+  struct gab_dispatch_table *tables[] = {gab.eg->dispatch.table,
+                                         gab.eg->dispatch.reclaim};
+  for (uint64_t i = 0; i < LEN_CARRAY(tables); i++) {
+    struct gab_dispatch_table *t = tables[i];
+    while (t) {
+      struct gab_dispatch_table *retired = t->retired;
+      free(t);
+      t = retired;
+    }
+  }
+
   v_gab_value_destroy(&gab.eg->scratch);
 
+  gab_slabdestroy(gab);
+
   mtx_destroy(&gab.eg->shapes_mtx);
-  mtx_destroy(&gab.eg->strings_mtx);
+  for (uint64_t i = 0; i < cGAB_STRING_SHARDS; i++)
+    mtx_destroy(&gab.eg->strings[i].mtx);
+
+  mtx_destroy(&gab.eg->dispatch.mtx);
   mtx_destroy(&gab.eg->sources_mtx);
   mtx_destroy(&gab.eg->modules_mtx);
+  mtx_destroy(&gab.eg->scratch_mtx);
 
   free(gab.eg);
 }
@@ -1201,11 +2004,14 @@ int gab_ndef(struct gab_triple gab, uint64_t len,
              struct gab_def_argt args[static len]) {
   gab_gclock(gab);
 
-  gab_value m = dodef(gab, gab_thisfibmsg(gab), len, args);
+  gab_value base = gab_thisfibmsg(gab);
+  gab_value m = dodef(gab, base, len, args);
 
   if (m == gab_undefined)
     return gab_gcunlock(gab), false;
 
+  dispatch_sync(gab.eg, base, m, len, args);
+
   gab_value parent = gab_thisfiber(gab);
 
   if (parent == gab_undefined) {
@@ -1222,14 +2028,16 @@ int gab_ndef(struct gab_triple gab, uint64_t len,
 
 struct gab_obj_string *gab_egstrfind(struct gab_eg *self, uint64_t hash,
                                      uint64_t len, const char *data) {
-  if (self->strings.len == 0)
+  d_strings *strings = &gab_egstrshard(self, hash)->strings;
+
+  if (strings->len == 0)
     return nullptr;
 
-  uint64_t index = hash & (self->strings.cap - 1);
+  uint64_t index = hash & (strings->cap - 1);
 
   for (;;) {
-    d_status status = d_strings_istatus(&self->strings, index);
-    struct gab_obj_string *key = d_strings_ikey(&self->strings, index);
+    d_status status = d_strings_istatus(strings, index);
+    struct gab_obj_string *key = d_strings_ikey(strings, index);
 
     switch (status) {
     case D_TOMBSTONE:
@@ -1237,11 +2045,14 @@ struct gab_obj_string *gab_egstrfind(struct gab_eg *self, uint64_t hash,
     case D_EMPTY:
       return nullptr;
     case D_FULL:
-      if (key->len == len && key->hash == hash && !memcmp(key->data, data, len))
+      // A string which has died stays in the table until it is freed.
+      if (key->len == len && key->hash == hash &&
+          !memcmp(key->data, data, len) &&
+          atomic_load_explicit(&key->header.references, memory_order_relaxed))
         return key;
     }
 
-    index = (index + 1) & (self->strings.cap - 1);
+    index = (index + 1) & (strings->cap - 1);
   }
 }
 
@@ -1284,10 +2095,15 @@ uint64_t gab_egkeep(struct gab_eg *gab, gab_value v) {
 
 uint64_t gab_negkeep(struct gab_eg *gab, uint64_t len,
                      gab_value values[static len]) {
+  mtx_lock(&gab->scratch_mtx);
+
   for (uint64_t i = 0; i < len; i++)
     if (gab_valiso(values[i]))
       v_gab_value_push(&gab->scratch, values[i]);
 
+  mtx_unlock(&gab->scratch_mtx);
+
+  gab_gcimmortal((struct gab_triple){.eg = gab}, len, values);
   return len;
 }
 
@@ -1497,39 +2313,16 @@ fin:
 /*  return 1;*/
 /*}*/
 
-#define MODULE_SYMBOL "gab_lib"
-
 typedef a_gab_value *(*handler_f)(struct gab_triple, const char *);
 
-typedef a_gab_value *(*module_f)(struct gab_triple);
-
 typedef struct {
   const char *prefix;
   const char *suffix;
 } resource;
 
-a_gab_value *gab_use_file(struct gab_triple gab, const char *path) {
-  a_char *src = gab_osread(path);
-
-  if (src == nullptr) {
-    gab_value reason = gab_string(gab, strerror(errno));
-    return gab_fpanic(gab, "Failed to load module: $", reason);
-  }
-
-  gab_value pkg = gab_build(gab, (struct gab_build_argt){
-                                     .name = path,
-                                     .source = (const char *)src->data,
-                                     .flags = gab.flags,
-                                     .len = 0,
-                                 });
-
-  a_char_destroy(src);
-
-  if (pkg == gab_undefined)
-    return nullptr;
-
+a_gab_value *gab_runmod(struct gab_triple gab, gab_value main) {
   gab_value fb = gab_arun(gab, (struct gab_run_argt){
-                                   .main = pkg,
+                                   .main = main,
                                    .flags = gab.flags,
                                });
 
@@ -1549,6 +2342,10 @@ a_gab_value *gab_use_file(struct gab_triple gab, const char *path) {
   struct gab_obj_fiber *f = GAB_VAL_TO_FIBER(fb);
   gab_value fbparent = gab_thisfiber(gab);
 
+  // The module's defs are already in the index, unless something else
+  // defined in between - then this leaves them pending.
+  dispatch_sync(gab.eg, f->messages, f->messages, 0, nullptr);
+
   if (fbparent == gab_undefined) {
     gab.eg->messages = f->messages;
   } else {
@@ -1556,9 +2353,113 @@ a_gab_value *gab_use_file(struct gab_triple gab, const char *path) {
     parent->messages = f->messages;
   }
 
-  a_gab_value *final =
-      gab_segmodput(gab.eg, path, pkg, res->len - 1, res->data + 1);
+  return a_gab_value_create(res->data + 1, res->len - 1);
+}
+
+// Flags which need the module to actually be compiled.
+#define fGAB_CACHE_BYPASS (fGAB_AST_DUMP | fGAB_BUILD_DUMP | fGAB_BUILD_CHECK)
+
+static a_char *cache_path(struct gab_eg *eg, const char *path,
+                          const char *ext) {
+  uint64_t hash = FNV1a_64((const uint8_t *)path, strlen(path));
+
+  int len = snprintf(nullptr, 0, "%s/%016" PRIx64 ".gbof%s", eg->cache, hash,
+                     ext);
+
+  char buffer[len + 1];
+  snprintf(buffer, len + 1, "%s/%016" PRIx64 ".gbof%s", eg->cache, hash, ext);
+
+  return a_char_create(buffer, len + 1);
+}
+
+static gab_value cache_load(struct gab_triple gab, const char *path,
+                            const char *source) {
+  a_char *cpath = cache_path(gab.eg, path, "");
+  a_char *obj = gab_osread(cpath->data);
+
+  a_char_destroy(cpath);
+
+  if (obj == nullptr)
+    return gab_undefined;
+
+  gab_value pkg = gab_loadgbof(gab, path, source, obj->len,
+                               (const uint8_t *)obj->data);
+
+  a_char_destroy(obj);
+  return pkg;
+}
+
+static void cache_store(struct gab_triple gab, const char *path,
+                        gab_value pkg) {
+  static _Atomic uint32_t ntmps;
+
+  /*
+   * Write to a temporary file and then move it into place, so that no one
+   * reads a partial object. The name is unique to this process and call, so
+   * writers don't collide - and a writer which died doesn't leave behind a
+   * file that stops anyone else from writing.
+   */
+  char ext[64];
+  snprintf(ext, sizeof(ext), ".%ld.%" PRIu32 ".tmp", (long)gab_osgetpid(),
+           ntmps++);
+
+  a_char *cpath = cache_path(gab.eg, path, "");
+  a_char *tmp = cache_path(gab.eg, path, ext);
+
+  FILE *f = fopen(tmp->data, "wbx");
+
+  if (f != nullptr) {
+    bool ok = gab_fwritegbof(f, pkg) == 0;
+    ok &= fclose(f) == 0;
+
+    if (!ok || rename(tmp->data, cpath->data))
+      remove(tmp->data);
+  }
+
+  a_char_destroy(cpath);
+  a_char_destroy(tmp);
+}
+
+a_gab_value *gab_use_file(struct gab_triple gab, const char *path) {
+  a_char *src = gab_osread(path);
+
+  if (src == nullptr) {
+    gab_value reason = gab_string(gab, strerror(errno));
+    return gab_fpanic(gab, "Failed to load module: $", reason);
+  }
 
+  bool cached = gab.eg->cache && !(gab.flags & fGAB_CACHE_BYPASS);
+
+  gab_value pkg = gab_undefined;
+
+  if (cached)
+    pkg = cache_load(gab, path, (const char *)src->data);
+
+  if (pkg == gab_undefined) {
+    pkg = gab_build(gab, (struct gab_build_argt){
+                             .name = path,
+                             .source = (const char *)src->data,
+                             .flags = gab.flags,
+                             .len = 0,
+                         });
+
+    if (cached && pkg != gab_undefined)
+      cache_store(gab, path, pkg);
+  }
+
+  a_char_destroy(src);
+
+  if (pkg == gab_undefined)
+    return nullptr;
+
+  a_gab_value *res = gab_runmod(gab, pkg);
+
+  if (res == nullptr)
+    return nullptr;
+
+  a_gab_value *final = gab_segmodput(gab.eg, path, pkg, res->len, res->data);
+
+  a_gab_value_destroy(res);
   return final;
 }
 
@@ -1681,20 +2582,12 @@ gab_value gab_arun(struct gab_triple gab, struct gab_run_argt args) {
                                     .argc = args.len,
                                 });
 
-  gab_iref(gab, fb);
-
 #if cGAB_LOG_EG
-  fprintf(stdout, "[WORKER %i] chnput ", gab.wkid);
+  fprintf(stdout, "[WORKER %i] schedule ", gab.wkid);
   gab_fprintf(stdout, "$\n", fb);
 #endif
 
-  // Somehow check if the put will block, and create a job in that case.
-  // Should check to see if the channel has takers waiting already.
-  gab_wkspawn(gab);
-
-  gab_chnput(gab, gab.eg->work_channel, fb);
-
-  gab_dref(gab, fb);
+  fiber_schedule(gab, fb);
 
   return fb;
 }
@@ -1714,9 +2607,7 @@ a_gab_value *gab_send(struct gab_triple gab, struct gab_send_argt args) {
 
   gab_iref(gab, fb);
 
-  gab_jbcreate(gab, next_available_job(gab), worker_job);
-
-  gab_chnput(gab, gab.eg->work_channel, fb);
+  fiber_schedule(gab, fb);
 
   a_gab_value *res = gab_fibawait(gab, fb);
 
@@ -17,67 +17,194 @@ static inline void epochinc(struct gab_triple gab) {
   gab.eg->jobs[gab.wkid].epoch++;
 }
 
-static inline struct gab_obj **bufdata(struct gab_triple gab, uint8_t b,
-                                       uint8_t wkid, uint8_t epoch) {
+static inline struct gab_gcbuf *buf(struct gab_triple gab, uint8_t b,
+                                    uint8_t wkid, uint8_t epoch) {
   assert(epoch < GAB_GCNEPOCHS);
   assert(b < kGAB_NBUF);
   assert(wkid < gab.eg->len);
-  return gab.eg->gc->buffers[wkid][b][epoch].data;
+  return &gab.eg->gc->buffers[wkid][b][epoch];
 }
 
 static inline uint64_t buflen(struct gab_triple gab, uint8_t b, uint8_t wkid,
                               uint8_t epoch) {
-  assert(epoch < GAB_GCNEPOCHS);
-  assert(b < kGAB_NBUF);
-  assert(wkid < gab.eg->len);
-  return gab.eg->gc->buffers[wkid][b][epoch].len;
+  return buf(gab, b, wkid, epoch)->len;
+}
+
+/*
+ * Nothing the engine allocates has a way to fail back to the program, so
+ * running out of memory is fatal.
+ */
+static void outofmemory(uint64_t size) {
+  fprintf(stderr, "gab: out of memory (allocating %" PRIu64 " bytes)\n", size);
+  exit(1);
+}
+
+/*
+ * Take an empty chunk from the pool, or allocate a new one.
+ */
+static struct gab_gcchunk *chunktake(struct gab_eg *eg) {
+  struct gab_gc *gc = eg->gc;
+
+  mtx_lock(&gc->pool.mtx);
+
+  struct gab_gcchunk *c = gc->pool.free;
+
+  if (c != nullptr) {
+    gc->pool.free = c->next;
+    gc->pool.len--;
+  }
+
+  mtx_unlock(&gc->pool.mtx);
+
+  if (c == nullptr)
+    c = gab_egmalloc(eg, sizeof(struct gab_gcchunk));
+
+  c->next = nullptr;
+  c->len = 0;
+  return c;
+}
+
+/*
+ * Give a list of chunks back to the pool. Whatever doesn't fit is freed, so
+ * that the memory from a burst of allocation is released once it's over.
+ */
+static void chunkgive(struct gab_eg *eg, struct gab_gcchunk *c) {
+  if (c == nullptr)
+    return;
+
+  struct gab_gc *gc = eg->gc;
+
+  mtx_lock(&gc->pool.mtx);
+
+  while (c != nullptr) {
+    struct gab_gcchunk *next = c->next;
+
+    if (gc->pool.len < cGAB_GC_MOD_CHUNK_POOL) {
+      c->next = gc->pool.free;
+      gc->pool.free = c;
+      gc->pool.len++;
+    } else {
+      gab_egfree(eg, c);
+    }
+
+    c = next;
+  }
+
+  mtx_unlock(&gc->pool.mtx);
 }
 
 static inline void bufpush(struct gab_triple gab, uint8_t b, uint8_t wkid,
                            uint8_t epoch, struct gab_obj *o) {
-  assert(epoch < GAB_GCNEPOCHS);
-  assert(b < kGAB_NBUF);
-  assert(wkid < gab.eg->len);
-  uint64_t len = buflen(gab, b, wkid, epoch);
-  struct gab_obj **buf = bufdata(gab, b, wkid, epoch);
-  buf[len] = o;
-  gab.eg->gc->buffers[wkid][b][epoch].len = len + 1;
+  struct gab_gcbuf *bf = buf(gab, b, wkid, epoch);
+  struct gab_gcchunk *tail = bf->tail;
+
+  if (__gab_unlikely(tail == nullptr || tail->len == cGAB_GC_MOD_CHUNK_LEN)) {
+    struct gab_gcchunk *c = chunktake(gab.eg);
+
+    if (tail == nullptr)
+      bf->head = c;
+    else
+      tail->next = c;
+
+    bf->tail = tail = c;
+  }
+
+  tail->data[tail->len++] = o;
+  bf->len++;
 }
 
 static inline void bufclear(struct gab_triple gab, uint8_t b, uint8_t wkid,
                             uint8_t epoch) {
-  assert(epoch < GAB_GCNEPOCHS);
-  assert(b < kGAB_NBUF);
-  assert(wkid < gab.eg->len);
-  gab.eg->gc->buffers[wkid][b][epoch].len = 0;
+  struct gab_gcbuf *bf = buf(gab, b, wkid, epoch);
+  chunkgive(gab.eg, bf->head);
+  bf->head = bf->tail = nullptr;
+  bf->len = 0;
 }
 
-static inline uint64_t do_increment(struct gab_gc *gc, struct gab_obj *obj) {
-  if (__gab_unlikely(obj->references == INT8_MAX)) {
-    uint64_t rc = d_gab_obj_read(&gc->overflow_rc, obj);
-
-    d_gab_obj_insert(&gc->overflow_rc, obj, rc + 1);
+/*
+ * Whether the object can be found through the intern table, which takes
+ * references to it without going through the gc.
+ */
+static inline bool weakly_held(struct gab_obj *obj) {
+  return obj->kind == kGAB_STRING &&
+         ((struct gab_obj_string *)obj)->rep == kGAB_STRREP_INTERNED;
+}
 
-    return rc + 1;
+/*
+ * While a collection is shared between threads, reference counts are only
+ * changed atomically. Interned strings are always changed atomically, because
+ * a lookup in the intern table may take a reference to one at any time (see
+ * gab_gcweakref). A count which reaches INT8_MAX overflows into overflow_rc,
+ * and only moves off of INT8_MAX while holding overflow_mtx.
+ */
+static inline bool rc_cas(struct gab_gc *gc, struct gab_obj *obj, uint8_t *rc,
+                          uint8_t to) {
+  if (!gc->help.sharing && !weakly_held(obj)) {
+    atomic_store_explicit(&obj->references, to, memory_order_relaxed);
+    return true;
   }
 
-  return obj->references++;
+  return atomic_compare_exchange_weak_explicit(
+      &obj->references, rc, to, memory_order_relaxed, memory_order_relaxed);
 }
 
-static inline uint64_t do_decrement(struct gab_gc *gc, struct gab_obj *obj) {
-  if (__gab_unlikely(obj->references == INT8_MAX)) {
-    uint64_t rc = d_gab_obj_read(&gc->overflow_rc, obj);
+static inline void do_increment(struct gab_gc *gc, struct gab_obj *obj) {
+  for (;;) {
+    uint8_t rc = atomic_load_explicit(&obj->references, memory_order_relaxed);
+
+    if (__gab_unlikely(rc == INT8_MAX)) {
+      mtx_lock(&gc->overflow_mtx);
+
+      if (obj->references != INT8_MAX) {
+        mtx_unlock(&gc->overflow_mtx);
+        continue;
+      }
+
+      uint64_t orc = d_gab_obj_read(&gc->overflow_rc, obj);
+      d_gab_obj_insert(&gc->overflow_rc, obj, orc + 1);
 
-    if (__gab_unlikely(rc == UINT8_MAX)) {
-      d_gab_obj_remove(&gc->overflow_rc, obj);
-      return obj->references--;
+      mtx_unlock(&gc->overflow_mtx);
+      return;
     }
 
-    d_gab_obj_insert(&gc->overflow_rc, obj, rc - 1);
-    return rc - 1;
+    if (rc_cas(gc, obj, &rc, rc + 1))
+      return;
   }
+}
+
+/*
+ * Returns the count left in the object, which is only zero for the one
+ * decrement which killed it.
+ */
+static inline uint8_t do_decrement(struct gab_gc *gc, struct gab_obj *obj) {
+  for (;;) {
+    uint8_t rc = atomic_load_explicit(&obj->references, memory_order_relaxed);
+
+    if (__gab_unlikely(rc == INT8_MAX)) {
+      mtx_lock(&gc->overflow_mtx);
+
+      if (obj->references != INT8_MAX) {
+        mtx_unlock(&gc->overflow_mtx);
+        continue;
+      }
+
+      uint64_t orc = d_gab_obj_read(&gc->overflow_rc, obj);
+
+      if (__gab_unlikely(orc == UINT8_MAX)) {
+        d_gab_obj_remove(&gc->overflow_rc, obj);
+        obj->references--;
+      } else {
+        d_gab_obj_insert(&gc->overflow_rc, obj, orc - 1);
+      }
+
+      rc = obj->references;
+      mtx_unlock(&gc->overflow_mtx);
+      return rc;
+    }
 
-  return obj->references--;
+    if (rc_cas(gc, obj, &rc, rc - 1))
+      return rc - 1;
+  }
 }
 
 #if cGAB_LOG_GC
@@ -89,15 +216,13 @@ void __queue_decrement(struct gab_triple gab, struct gab_obj *obj,
 #else
 void queue_decrement(struct gab_triple gab, struct gab_obj *obj) {
 #endif
+  if (GAB_OBJ_IS_IMMORTAL(obj))
+    return;
+
   int32_t e = epochget(gab);
 
   gab_gctrigger(gab);
 
-  while (buflen(gab, kGAB_BUF_DEC, gab.wkid, e) >= cGAB_GC_MOD_BUFF_MAX) {
-    gab_yield(gab);
-    e = epochget(gab);
-  }
-
   bufpush(gab, kGAB_BUF_DEC, gab.wkid, e, obj);
 
 #if cGAB_LOG_GC
@@ -106,19 +231,80 @@ void queue_decrement(struct gab_triple gab, struct gab_obj *obj) {
 #endif
 }
 
-void queue_increment(struct gab_triple gab, struct gab_obj *obj) {
+/*
+ * Take a counted reference to an object found through a weak reference, like
+ * the string intern table, unless it has already died. The reference is let go
+ * of by this epoch's decrements, like the one an object is created with.
+ */
+bool gab_gcweakref(struct gab_triple gab, struct gab_obj *obj) {
+  if (GAB_OBJ_IS_IMMORTAL(obj))
+    return true;
+
+  struct gab_gc *gc = gab.eg->gc;
+
+  for (;;) {
+    uint8_t rc = atomic_load_explicit(&obj->references, memory_order_relaxed);
+
+    if (rc == 0)
+      return false;
+
+    if (__gab_unlikely(rc == INT8_MAX)) {
+      mtx_lock(&gc->overflow_mtx);
+
+      if (obj->references != INT8_MAX) {
+        mtx_unlock(&gc->overflow_mtx);
+        continue;
+      }
+
+      uint64_t orc = d_gab_obj_read(&gc->overflow_rc, obj);
+      d_gab_obj_insert(&gc->overflow_rc, obj, orc + 1);
+
+      mtx_unlock(&gc->overflow_mtx);
+      break;
+    }
+
+    if (atomic_compare_exchange_weak_explicit(&obj->references, &rc, rc + 1,
+                                              memory_order_relaxed,
+                                              memory_order_relaxed))
+      break;
+  }
+
+  queue_decrement(gab, obj);
+  return true;
+}
+
+/*
+ * The decrement made for an object's creation is tagged in the low bit, so
+ * that processing it can tell that the object is no longer fresh.
+ */
+void gab_gcdrefnew(struct gab_triple gab, struct gab_obj *obj) {
+  if (GAB_OBJ_IS_IMMORTAL(obj))
+    return;
+
+#if cGAB_DEBUG_GC
+  gab_collect(gab);
+#endif
+
   int32_t e = epochget(gab);
 
   gab_gctrigger(gab);
 
-  while (buflen(gab, kGAB_BUF_INC, gab.wkid, e) >= cGAB_GC_MOD_BUFF_MAX) {
-    if (gab.eg->gc->schedule == gab.wkid)
-      gab_gcepochnext(gab);
+  bufpush(gab, kGAB_BUF_DEC, gab.wkid, e,
+          (struct gab_obj *)((uintptr_t)obj | 1));
+
+#if cGAB_LOG_GC
+  printf("QDEC\t%i\t%p\t%i\t%s:%i\n", epochget(gab), obj, obj->references,
+         __FUNCTION__, __LINE__);
+#endif
+}
 
-    e = epochget(gab);
+void queue_increment(struct gab_triple gab, struct gab_obj *obj) {
+  if (GAB_OBJ_IS_IMMORTAL(obj))
+    return;
 
-    thrd_yield();
-  }
+  int32_t e = epochget(gab);
+
+  gab_gctrigger(gab);
 
   bufpush(gab, kGAB_BUF_INC, gab.wkid, e, obj);
 
@@ -127,13 +313,30 @@ void queue_increment(struct gab_triple gab, struct gab_obj *obj) {
 #endif
 }
 
+/*
+ * The objects which this thread found dead during the current collection.
+ */
+static thread_local v_gab_obj *dead;
+
+/*
+ * The candidate roots of garbage cycles which this thread found during the
+ * current collection.
+ */
+static thread_local v_gab_obj *roots;
+
 void queue_destroy(struct gab_triple gab, struct gab_obj *obj) {
-  if (GAB_OBJ_IS_BUFFERED(obj))
+  uint8_t flags = atomic_fetch_or_explicit(&obj->flags, fGAB_OBJ_BUFFERED,
+                                           memory_order_relaxed);
+
+  if (flags & fGAB_OBJ_BUFFERED)
     return;
 
-  GAB_OBJ_BUFFERED(obj);
+  // The cycle collector still holds this object, and frees it once it lets
+  // go.
+  if (flags & (fGAB_OBJ_ROOT | fGAB_OBJ_CYCLIC))
+    return;
 
-  v_gab_obj_push(&gab.eg->gc->dead, obj);
+  v_gab_obj_push(dead, obj);
 
   assert(obj->references == 0);
 
@@ -144,25 +347,25 @@ void queue_destroy(struct gab_triple gab, struct gab_obj *obj) {
 
 static inline void for_buf_do(uint8_t b, uint8_t wkid, uint8_t epoch,
                               gab_gc_visitor fnc, struct gab_triple gab) {
-  struct gab_obj **buf = bufdata(gab, b, wkid, epoch);
   uint64_t len = buflen(gab, b, wkid, epoch);
-  assert(len <= cGAB_GC_MOD_BUFF_MAX);
 
 #if cGAB_LOG_GC
   printf("FORDO\t%i\t%i\t(%lu / %i)\n", epoch, wkid, len, cGAB_GC_MOD_BUFF_MAX);
 #endif
 
-  for (uint64_t i = 0; i < len; i++) {
-    struct gab_obj *obj = buf[i];
+  for (struct gab_gcchunk *c = buf(gab, b, wkid, epoch)->head; c; c = c->next) {
+    for (uint64_t i = 0; i < c->len; i++) {
+      struct gab_obj *obj = c->data[i];
 
 #if cGAB_LOG_GC
-    if (GAB_OBJ_IS_FREED(obj)) {
-      printf("UAF\t%p\n", obj);
-      exit(1);
-    }
+      if (GAB_OBJ_IS_FREED((struct gab_obj *)((uintptr_t)obj & ~1))) {
+        printf("UAF\t%p\n", obj);
+        exit(1);
+      }
 #endif
 
-    fnc(gab, obj);
+      fnc(gab, obj);
+    }
   }
 
   // Sanity check that buffer hasn't been modified while operating over buffer
@@ -178,6 +381,15 @@ static inline void for_child_do(struct gab_obj *obj, gab_gc_visitor fnc,
   default:
     break;
 
+  case kGAB_STRING: {
+    struct gab_obj_string *str = (struct gab_obj_string *)obj;
+
+    if (str->rep == kGAB_STRREP_SLICE)
+      fnc(gab, gab_valtoo(((struct gab_obj_strslice *)obj)->parent));
+
+    break;
+  }
+
   case kGAB_FIBER: {
     struct gab_obj_fiber *fib = (struct gab_obj_fiber *)obj;
 
@@ -259,6 +471,49 @@ static inline void for_child_do(struct gab_obj *obj, gab_gc_visitor fnc,
 
 static inline void dec_obj_ref(struct gab_triple gab, struct gab_obj *obj);
 
+static inline void for_buffered_do(struct gab_obj_channel *channel,
+                                   gab_gc_visitor fnc, struct gab_triple gab) {
+  for (uint64_t pos = channel->head; pos < channel->tail; pos++) {
+    gab_value v = channel->buffer[pos % channel->len].value;
+
+    if (gab_valiso(v))
+      fnc(gab, gab_valtoo(v));
+  }
+}
+
+/*
+ * The objects found by the current call to gab_gcimmortal.
+ */
+static thread_local v_gab_obj *forever;
+
+static void immortal_child(struct gab_triple gab, struct gab_obj *obj) {
+  if (!GAB_OBJ_IS_IMMORTAL(obj))
+    v_gab_obj_push(forever, obj);
+}
+
+void gab_gcimmortal(struct gab_triple gab, uint64_t len, gab_value *values) {
+  v_gab_obj stack;
+  v_gab_obj_create(&stack, len + 8);
+  forever = &stack;
+
+  for (uint64_t i = 0; i < len; i++)
+    if (gab_valiso(values[i]))
+      v_gab_obj_push(&stack, gab_valtoo(values[i]));
+
+  while (stack.len) {
+    struct gab_obj *obj = v_gab_obj_pop(&stack);
+
+    if (atomic_fetch_or_explicit(&obj->flags, fGAB_OBJ_IMMORTAL,
+                                 memory_order_relaxed) &
+        fGAB_OBJ_IMMORTAL)
+      continue;
+
+    for_child_do(obj, immortal_child, gab);
+  }
+
+  v_gab_obj_destroy(&stack);
+}
+
 #if cGAB_LOG_GC
 #define destroy(gab, obj) _destroy(gab, obj, __FUNCTION__, __LINE__)
 static inline void _destroy(struct gab_triple gab, struct gab_obj *obj,
@@ -284,6 +539,9 @@ static inline void destroy(struct gab_triple gab, struct gab_obj *obj) {
 #endif
 }
 
+static void destroyn(struct gab_triple gab, uint64_t len,
+                     struct gab_obj **objs);
+
 /*
  * ISSUE: When we call process epoch, we move
  * a worker from epoch 0 -> 1. This means it is now
@@ -294,19 +552,133 @@ static inline void destroy(struct gab_triple gab, struct gab_obj *obj) {
  * which is also epoch/buffer 1.
  */
 
+/*
+ * Whether an object can be part of a cycle. Only buffered channels and boxes
+ * can be changed to refer to an object made after them - but any object which
+ * refers to one of those can be part of the cycle through it.
+ */
+static inline bool cyc_kind(struct gab_obj *obj) {
+  switch (obj->kind) {
+  case kGAB_BLOCK:
+  case kGAB_BOX:
+  case kGAB_RECORD:
+  case kGAB_RECORDNODE:
+  case kGAB_FIBER:
+  case kGAB_CHANNEL:
+  case kGAB_CHANNELCLOSED:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/*
+ * Whether an object's children are fixed once it has been made.
+ */
+static inline bool cyc_immutable(struct gab_obj *obj) {
+  switch (obj->kind) {
+  case kGAB_BLOCK:
+  case kGAB_RECORD:
+  case kGAB_RECORDNODE:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/*
+ * A decrement which leaves an object alive may have left it only referenced
+ * by a cycle. Remember it, to be checked by the cycle collector.
+ */
+static inline void cyc_record(struct gab_obj *obj) {
+  if (!cyc_kind(obj))
+    return;
+
+  uint8_t flags = atomic_load_explicit(&obj->flags, memory_order_relaxed);
+
+  if (flags & (fGAB_OBJ_ROOT | fGAB_OBJ_ACYCLIC | fGAB_OBJ_BUFFERED))
+    return;
+
+  // The decrement made for the object's creation is still to come, and it
+  // records the object then if it is still alive. Most objects die there.
+  if (atomic_load_explicit(&obj->flags, memory_order_seq_cst) & fGAB_OBJ_FRESH)
+    return;
+
+  if (atomic_fetch_or_explicit(&obj->flags, fGAB_OBJ_ROOT,
+                               memory_order_relaxed) &
+      fGAB_OBJ_ROOT)
+    return;
+
+  v_gab_obj_push(roots, obj);
+}
+
+/*
+ * Any change to the count of an object found in a garbage cycle means that
+ * the cycle may not be garbage after all.
+ */
+static inline void cyc_touch(struct gab_obj *obj) {
+  if (__gab_unlikely(atomic_load_explicit(&obj->flags, memory_order_relaxed) &
+                     fGAB_OBJ_CYCLIC))
+    atomic_fetch_or_explicit(&obj->flags, fGAB_OBJ_TOUCHED,
+                             memory_order_relaxed);
+}
+
 static inline void dec_obj_ref(struct gab_triple gab, struct gab_obj *obj) {
 #if cGAB_LOG_GC
   printf("DEC\t%i\t%p\t%d\n", epochget(gab), obj, obj->references - 1);
 #endif
 
-  do_decrement(gab.eg->gc, obj);
+  if (GAB_OBJ_IS_IMMORTAL(obj))
+    return;
+
+  cyc_touch(obj);
 
-  if (obj->references == 0) {
+  if (do_decrement(gab.eg->gc, obj) == 0) {
     if (!GAB_OBJ_IS_NEW(obj))
       for_child_do(obj, dec_obj_ref, gab);
 
+    // Values left in a channel's buffer were referenced when they were put,
+    // whether or not the channel itself was ever counted.
+    if (obj->kind == kGAB_CHANNEL || obj->kind == kGAB_CHANNELCLOSED)
+      for_buffered_do((struct gab_obj_channel *)obj, dec_obj_ref, gab);
+
     queue_destroy(gab, obj);
+  } else {
+    cyc_record(obj);
+  }
+}
+
+/*
+ * Process a decrement from a DEC buffer, which may be the one made for the
+ * object's creation.
+ */
+static inline void dec_buf_ref(struct gab_triple gab, struct gab_obj *obj) {
+  if ((uintptr_t)obj & 1) {
+    obj = (struct gab_obj *)((uintptr_t)obj & ~1);
+
+    // An object which was never counted, and still only has the reference it
+    // was made with, dies young. Nothing else can be looking at it, so it is
+    // let go of without any atomic operations.
+    if (atomic_load_explicit(&obj->flags, memory_order_relaxed) ==
+            (fGAB_OBJ_NEW | fGAB_OBJ_FRESH) &&
+        atomic_load_explicit(&obj->references, memory_order_relaxed) == 1 &&
+        obj->kind != kGAB_CHANNEL && obj->kind != kGAB_CHANNELCLOSED &&
+        !weakly_held(obj)) {
+#if cGAB_LOG_GC
+      printf("YOUNG\t%i\t%p\n", epochget(gab), obj);
+#endif
+      atomic_store_explicit(&obj->references, 0, memory_order_relaxed);
+      atomic_store_explicit(&obj->flags, fGAB_OBJ_NEW | fGAB_OBJ_BUFFERED,
+                            memory_order_relaxed);
+      v_gab_obj_push(dead, obj);
+      return;
+    }
+
+    atomic_fetch_and_explicit(&obj->flags, ~fGAB_OBJ_FRESH,
+                              memory_order_seq_cst);
   }
+
+  dec_obj_ref(gab, obj);
 }
 
 static inline void inc_obj_ref(struct gab_triple gab, struct gab_obj *obj) {
@@ -314,13 +686,21 @@ static inline void inc_obj_ref(struct gab_triple gab, struct gab_obj *obj) {
   printf("INC\t%i\t%p\t%d\n", epochget(gab), obj, obj->references + 1);
 #endif
 
-  do_increment(gab.eg->gc, obj);
+  // An immortal object may have been made so with its first increment still
+  // waiting, so it goes on to count its children all the same.
+  if (!GAB_OBJ_IS_IMMORTAL(obj)) {
+    cyc_touch(obj);
+    do_increment(gab.eg->gc, obj);
+  }
 
-  if (GAB_OBJ_IS_NEW(obj)) {
+  // Only the first increment of a new object counts its children.
+  if (GAB_OBJ_IS_NEW(obj) &&
+      atomic_fetch_and_explicit(&obj->flags, ~fGAB_OBJ_NEW,
+                                memory_order_relaxed) &
+          fGAB_OBJ_NEW) {
 #if cGAB_LOG_GC
     printf("NEW\t%i\t%p\n", epochget(gab), obj);
 #endif
-    GAB_OBJ_NOT_NEW(obj);
     for_child_do(obj, inc_obj_ref, gab);
   }
 }
@@ -427,75 +807,807 @@ gab_value gab_dref(struct gab_triple gab, gab_value value) {
   return value;
 }
 
-void gab_gccreate(struct gab_triple gab) {
-  gab.eg->gc->schedule = -1;
-  d_gab_obj_create(&gab.eg->gc->overflow_rc, 8);
-  v_gab_obj_create(&gab.eg->gc->dead, 8);
+enum {
+  kGAB_GCPHASE_INC,
+  kGAB_GCPHASE_DEC,
+  kGAB_GCPHASE_FREE,
+  kGAB_GCPHASE_EXIT,
+};
 
-  for (int i = 0; i < gab.eg->len; i++) {
-    for (int b = 0; b < kGAB_NBUF; b++) {
-      for (int e = 0; e < GAB_GCNEPOCHS; e++) {
-        bufclear(gab, b, i, e);
-      }
+/*
+ * Do a share of the current phase. Buffers are handed out a chunk at a time,
+ * and dead objects in batches of the same size.
+ */
+static void helpwork(struct gab_triple gab) {
+  struct gab_gc *gc = gab.eg->gc;
+  struct gab_gchelp *h = &gc->help;
+
+  // The objects to free are the last nwork in the dead list.
+  if (h->phase == kGAB_GCPHASE_FREE) {
+    struct gab_obj **objs = gc->dead.data + gc->dead.len - h->nwork;
+
+    for (;;) {
+      uint64_t i = atomic_fetch_add_explicit(&h->next, cGAB_GC_MOD_CHUNK_LEN,
+                                             memory_order_relaxed);
+
+      if (i >= h->nwork)
+        return;
+
+      uint64_t end = i + cGAB_GC_MOD_CHUNK_LEN;
+      end = end < h->nwork ? end : h->nwork;
+
+      destroyn(gab, end - i, objs + i);
     }
   }
-};
 
-void gab_gcdestroy(struct gab_triple gab) {
-  d_gab_obj_destroy(&gab.eg->gc->overflow_rc);
-  v_gab_obj_destroy(&gab.eg->gc->dead);
-}
+  for (;;) {
+    uint64_t i = atomic_fetch_add_explicit(&h->next, 1, memory_order_relaxed);
 
-static inline void collect_dead(struct gab_triple gab) {
-  while (gab.eg->gc->dead.len) {
-    struct gab_obj *o = v_gab_obj_pop(&gab.eg->gc->dead);
+    if (i >= h->nwork)
+      return;
 
-    destroy(gab, o);
+    struct gab_gcchunk *c = h->work[i];
+
+    for (uint64_t j = 0; j < c->len; j++) {
+      if (h->phase == kGAB_GCPHASE_INC)
+        inc_obj_ref(gab, c->data[j]);
+      else
+        dec_buf_ref(gab, c->data[j]);
+    }
   }
 }
 
-void gab_gclock(struct gab_triple gab) {
-  struct gab_jb *wk = gab.eg->jobs + gab.wkid;
-  assert(wk->locked < UINT8_MAX);
-  wk->locked += 1;
+struct gab_gchelpargt {
+  struct gab_triple gab;
+  struct gab_gchelper *self;
+};
+
+static int32_t gc_helper(void *data) {
+  struct gab_gchelpargt args = *(struct gab_gchelpargt *)data;
+  free(data);
+
+  struct gab_gchelp *h = &args.gab.eg->gc->help;
+  dead = &args.self->dead;
+  roots = &args.self->roots;
+
+  for (;;) {
+    if (!gab_park(&args.self->parker, (uint64_t)-1))
+      continue;
+
+    if (h->phase == kGAB_GCPHASE_EXIT)
+      return 0;
+
+    helpwork(args.gab);
+
+    // The last helper to finish wakes the gc job.
+    if (atomic_fetch_sub_explicit(&h->active, 1, memory_order_acq_rel) == 1)
+      gab_unpark(&h->parker);
+  }
 }
 
 /*
- * There was a bug where objects were beging freed *while they were in the locke
- * queue*. This was resolved by marking locked objects as *buffered* until they
- * are unlocked.
+ * Start the helpers, if they haven't been already. There is one for each job
+ * after the first, so that a collection can use as many threads as the
+ * engine does.
  */
-void gab_gcunlock(struct gab_triple gab) {
-  struct gab_jb *wk = gab.eg->jobs + gab.wkid;
-  assert(wk->locked > 0);
-  wk->locked -= 1;
+static bool helpstart(struct gab_triple gab) {
+  struct gab_gchelp *h = &gab.eg->gc->help;
 
-  if (!wk->locked) {
-    gab_ndref(gab, 1, wk->lock_keep.len, wk->lock_keep.data);
+  if (h->nhelpers)
+    return true;
 
-    for (uint64_t i = 0; i < wk->lock_keep.len; i++)
-      GAB_OBJ_NOT_BUFFERED(gab_valtoo(v_gab_value_val_at(&wk->lock_keep, i)));
+  uint64_t n = gab.eg->len > 2 ? gab.eg->len - 2 : 0;
+  n = n < cGAB_GC_HELPERS_MAX ? n : cGAB_GC_HELPERS_MAX;
 
-    wk->lock_keep.len = 0;
+  for (uint64_t i = 0; i < n; i++) {
+    struct gab_gchelper *self = h->helpers + i;
+
+    gab_parkercreate(&self->parker);
+    v_gab_obj_create(&self->dead, 8);
+    v_gab_obj_create(&self->roots, 8);
+
+    struct gab_gchelpargt *args = malloc(sizeof(struct gab_gchelpargt));
+    args->gab = gab;
+    args->self = self;
+
+    if (thrd_create(&self->td, gc_helper, args) != thrd_success) {
+      free(args);
+      v_gab_obj_destroy(&self->dead);
+      v_gab_obj_destroy(&self->roots);
+      gab_parkerdestroy(&self->parker);
+      break;
+    }
+
+    h->nhelpers++;
   }
+
+  return h->nhelpers;
 }
 
-void processincrements(struct gab_triple gab, int32_t epoch) {
-#if cGAB_LOG_GC
-  printf("IEPOCH\t%i\n", epoch);
-#endif
+static void helpstop(struct gab_triple gab) {
+  struct gab_gchelp *h = &gab.eg->gc->help;
 
-  for (uint8_t wkid = 0; wkid < gab.eg->len; wkid++) {
-    // For the stack and increment buffers, increment the object
-    for_buf_do(kGAB_BUF_STK, wkid, epoch, inc_obj_ref, gab);
-    for_buf_do(kGAB_BUF_INC, wkid, epoch, inc_obj_ref, gab);
-    // Reset the length of the inf buffer for this worker
-    bufclear(gab, kGAB_BUF_STK, wkid, epoch);
-    bufclear(gab, kGAB_BUF_INC, wkid, epoch);
+  h->phase = kGAB_GCPHASE_EXIT;
+
+  for (uint64_t i = 0; i < h->nhelpers; i++) {
+    gab_unpark(&h->helpers[i].parker);
+    thrd_join(h->helpers[i].td, nullptr);
+    v_gab_obj_destroy(&h->helpers[i].dead);
+    v_gab_obj_destroy(&h->helpers[i].roots);
+    gab_parkerdestroy(&h->helpers[i].parker);
   }
-#if cGAB_LOG_GC
-  printf("IEPOCH!\t%i\n", epoch);
-#endif
+
+  h->nhelpers = 0;
+  free(h->work);
+  gab_parkerdestroy(&h->parker);
+}
+
+/*
+ * Run a phase of the collection on the gc job and every helper, and wait
+ * for all of them to finish it.
+ */
+static void helpshare(struct gab_triple gab, uint8_t phase) {
+  struct gab_gchelp *h = &gab.eg->gc->help;
+
+  h->phase = phase;
+  atomic_store_explicit(&h->next, 0, memory_order_relaxed);
+  atomic_store_explicit(&h->active, h->nhelpers, memory_order_relaxed);
+
+  h->sharing = true;
+
+  for (uint64_t i = 0; i < h->nhelpers; i++)
+    gab_unpark(&h->helpers[i].parker);
+
+  helpwork(gab);
+
+  while (atomic_load_explicit(&h->active, memory_order_acquire) > 0)
+    gab_park(&h->parker, (uint64_t)-1);
+
+  h->sharing = false;
+}
+
+/*
+ * Gather every chunk of the stack buffers and buffer 'b' for the epoch, to
+ * be handed out by helpwork.
+ */
+static void helpgather(struct gab_triple gab, uint8_t b, int32_t epoch) {
+  struct gab_gchelp *h = &gab.eg->gc->help;
+
+  h->nwork = 0;
+
+  for (uint8_t wkid = 0; wkid < gab.eg->len; wkid++) {
+    for (uint8_t i = 0; i < 2; i++) {
+      struct gab_gcbuf *bf = buf(gab, i ? b : kGAB_BUF_STK, wkid, epoch);
+
+      for (struct gab_gcchunk *c = bf->head; c; c = c->next) {
+        if (h->nwork == h->capwork) {
+          h->capwork = h->capwork ? h->capwork * 2 : 64;
+          h->work = realloc(h->work, sizeof(struct gab_gcchunk *) * h->capwork);
+        }
+
+        h->work[h->nwork++] = c;
+      }
+    }
+  }
+}
+
+void gab_gccreate(struct gab_triple gab) {
+  gab.eg->gc->schedule = -1;
+  mtx_init(&gab.eg->gc->overflow_mtx, mtx_plain);
+  d_gab_obj_create(&gab.eg->gc->overflow_rc, 8);
+  v_gab_obj_create(&gab.eg->gc->dead, 8);
+
+  for (int i = 0; i < GAB_GCNPAUSES; i++)
+    gab.eg->gc->pauses[i] = 0;
+
+  gab.eg->gc->help.sharing = false;
+  gab.eg->gc->help.nhelpers = 0;
+  gab_parkercreate(&gab.eg->gc->help.parker);
+  gab.eg->gc->help.nwork = 0;
+  gab.eg->gc->help.capwork = 0;
+  gab.eg->gc->help.work = nullptr;
+
+  gab.eg->gc->cycles.fail = false;
+  gab.eg->gc->cycles.budget = cGAB_GC_CYCLE_BUDGET;
+  v_gab_obj_create(&gab.eg->gc->cycles.roots, 8);
+  v_gab_obj_create(&gab.eg->gc->cycles.white, 8);
+  v_gab_obj_create(&gab.eg->gc->cycles.stack, 8);
+  v_gab_obj_create(&gab.eg->gc->cycles.seen, 8);
+
+  mtx_init(&gab.eg->gc->pool.mtx, mtx_plain);
+  gab.eg->gc->pool.len = 0;
+  gab.eg->gc->pool.free = nullptr;
+
+  for (int i = 0; i < gab.eg->len; i++) {
+    for (int b = 0; b < kGAB_NBUF; b++) {
+      for (int e = 0; e < GAB_GCNEPOCHS; e++) {
+        struct gab_gcbuf *bf = buf(gab, b, i, e);
+        bf->head = bf->tail = nullptr;
+        bf->len = 0;
+      }
+    }
+  }
+};
+
+void gab_gcdestroy(struct gab_triple gab) {
+  struct gab_gccycles *cyc = &gab.eg->gc->cycles;
+
+  // Free what died while the cycle collector was holding on to it.
+  for (uint64_t i = 0; i < cyc->roots.len; i++) {
+    struct gab_obj *obj = v_gab_obj_val_at(&cyc->roots, i);
+
+    if (obj->references == 0)
+      v_gab_obj_push(&gab.eg->gc->dead, obj);
+  }
+
+  for (uint64_t i = 0; i < cyc->white.len; i++) {
+    struct gab_obj *obj = v_gab_obj_val_at(&cyc->white, i);
+
+    if (obj->references == 0 && !(obj->flags & fGAB_OBJ_ROOT))
+      v_gab_obj_push(&gab.eg->gc->dead, obj);
+  }
+
+  while (gab_gcsweep(gab))
+    ;
+
+  helpstop(gab);
+
+  mtx_destroy(&gab.eg->gc->overflow_mtx);
+  d_gab_obj_destroy(&gab.eg->gc->overflow_rc);
+  v_gab_obj_destroy(&gab.eg->gc->dead);
+
+  v_gab_obj_destroy(&cyc->roots);
+  v_gab_obj_destroy(&cyc->white);
+  v_gab_obj_destroy(&cyc->stack);
+  v_gab_obj_destroy(&cyc->seen);
+
+  for (int i = 0; i < gab.eg->len; i++)
+    for (int b = 0; b < kGAB_NBUF; b++)
+      for (int e = 0; e < GAB_GCNEPOCHS; e++)
+        bufclear(gab, b, i, e);
+
+  struct gab_gcchunk *c = gab.eg->gc->pool.free;
+  while (c) {
+    struct gab_gcchunk *next = c->next;
+    gab_egfree(gab.eg, c);
+    c = next;
+  }
+
+  mtx_destroy(&gab.eg->gc->pool.mtx);
+}
+
+/*
+ * Objects live in slots, carved out of a slab. Each slot begins with a
+ * pointer back to its slab, so a slot can be freed without knowing its size.
+ * Objects too large for a slot begin with a null pointer instead.
+ *
+ * Slabs belong to the job which allocates from them. Only that job touches
+ * the free list. Every other thread frees onto the remote list, which the
+ * owner takes all at once when the free list runs dry. Usually that other
+ * thread is the gc job, which frees what all the workers allocated.
+ *
+ * A slab counts the slots taken from it, and the slots freed back. Once the
+ * two match it holds no objects, and the gc job gives it back to the os.
+ */
+struct gab_slab {
+  struct gab_slab *next;
+
+  uint64_t slot;
+
+  void *free;
+  _Atomic(void *) remote;
+
+  uint64_t taken;
+  _Atomic uint64_t freed;
+
+  char *bump, *end;
+
+  _Alignas(16) char data[];
+};
+
+#define SLAB_HEADER sizeof(struct gab_slab *)
+
+static inline uint64_t slab_class(uint64_t size) {
+  return (size + SLAB_HEADER + 15) / 16 - 1;
+}
+
+static struct gab_slab *slab_create(uint64_t class) {
+  struct gab_slab *slab = malloc(cGAB_SLAB_SIZE);
+
+  if (slab == nullptr)
+    outofmemory(cGAB_SLAB_SIZE);
+
+  slab->next = nullptr;
+  slab->slot = (class + 1) * 16;
+  slab->free = nullptr;
+  slab->remote = nullptr;
+  slab->taken = 0;
+  slab->freed = 0;
+  slab->bump = slab->data;
+  slab->end = (char *)slab + cGAB_SLAB_SIZE;
+
+  return slab;
+}
+
+/*
+ * Take a free slot from the slab, or nullptr if it is full.
+ */
+static inline char *slab_take(struct gab_slab *slab) {
+  if (slab->free == nullptr && atomic_load_explicit(&slab->remote,
+                                                    memory_order_relaxed))
+    slab->free =
+        atomic_exchange_explicit(&slab->remote, nullptr, memory_order_acquire);
+
+  if (slab->free != nullptr) {
+    char *slot = slab->free;
+    slab->free = *(void **)(slot + SLAB_HEADER);
+    slab->taken++;
+    return slot;
+  }
+
+  if (slab->end - slab->bump >= slab->slot) {
+    char *slot = slab->bump;
+    slab->bump += slab->slot;
+    *(struct gab_slab **)slot = slab;
+    slab->taken++;
+    return slot;
+  }
+
+  return nullptr;
+}
+
+static char *slab_alloc(struct gab_slabs *slabs, uint64_t class) {
+  struct gab_slab **head = slabs->head + class;
+
+  if (*head) {
+    char *slot = slab_take(*head);
+
+    if (slot)
+      return slot;
+  }
+
+  // The first slab is full. Every other one may be freed by the gc job, so
+  // only take from them while holding the lock.
+  mtx_lock(&slabs->mtx);
+
+  struct gab_slab *found = nullptr;
+
+  // Look for one which has had slots freed since, and move it to the front.
+  for (struct gab_slab **s = *head ? &(*head)->next : head; *s;
+       s = &(*s)->next) {
+    if (atomic_load_explicit(&(*s)->remote, memory_order_relaxed)) {
+      found = *s;
+      *s = found->next;
+      break;
+    }
+  }
+
+  if (found == nullptr)
+    found = slab_create(class);
+
+  found->next = *head;
+  *head = found;
+
+  char *slot = slab_take(found);
+
+  mtx_unlock(&slabs->mtx);
+  return slot;
+}
+
+/*
+ * Give a run of n slots, linked from first to last, back to their slab.
+ */
+static void slab_freerun(struct gab_slab *slab, char *first, char *last,
+                         uint64_t n) {
+  void *head = atomic_load_explicit(&slab->remote, memory_order_relaxed);
+
+  do {
+    *(void **)(last + SLAB_HEADER) = head;
+  } while (!atomic_compare_exchange_weak_explicit(
+      &slab->remote, &head, first, memory_order_release, memory_order_relaxed));
+
+  // This is our last touch of the slab. Once the counts match, it may be
+  // freed.
+  atomic_fetch_add_explicit(&slab->freed, n, memory_order_release);
+}
+
+static void slab_free(char *slot) {
+  struct gab_slab *slab = *(struct gab_slab **)slot;
+
+  if (slab == nullptr)
+    return free(slot);
+
+  slab_freerun(slab, slot, slot, 1);
+}
+
+/*
+ * Free every slab which holds no objects, except the first of each list -
+ * its owner takes from it without the lock.
+ */
+static void slabs_trim(struct gab_slabs *slabs) {
+  mtx_lock(&slabs->mtx);
+
+  for (uint64_t c = 0; c < GAB_SLAB_NCLASSES; c++) {
+    if (slabs->head[c] == nullptr)
+      continue;
+
+    struct gab_slab **s = &slabs->head[c]->next;
+
+    while (*s) {
+      struct gab_slab *slab = *s;
+
+      if (slab->taken ==
+          atomic_load_explicit(&slab->freed, memory_order_acquire)) {
+        *s = slab->next;
+        free(slab);
+      } else {
+        s = &slab->next;
+      }
+    }
+  }
+
+  mtx_unlock(&slabs->mtx);
+}
+
+/*
+ * The slabs the calling thread allocates from, if not its job's.
+ */
+static thread_local struct gab_slabs *ownslabs;
+
+void gab_slabsown(struct gab_slabs *slabs) { ownslabs = slabs; }
+
+struct gab_obj *gab_slaballoc(struct gab_triple gab, struct gab_obj *obj,
+                              uint64_t size) {
+  if (size == 0) {
+    slab_free((char *)obj - SLAB_HEADER);
+    return nullptr;
+  }
+
+  uint64_t class = slab_class(size);
+
+  if (class >= GAB_SLAB_NCLASSES) {
+    // Use 'calloc' to zero-initialize all the memory.
+    char *slot = calloc(1, SLAB_HEADER + size);
+
+    if (slot == nullptr)
+      outofmemory(size);
+
+    return (struct gab_obj *)(slot + SLAB_HEADER);
+  }
+
+  struct gab_slabs *slabs = &gab.eg->jobs[gab.wkid].slabs;
+
+  if (!gab.wkid && ownslabs)
+    slabs = ownslabs;
+
+  char *slot = slab_alloc(slabs, class);
+  memset(slot + SLAB_HEADER, 0, size);
+
+  return (struct gab_obj *)(slot + SLAB_HEADER);
+}
+
+/*
+ * The hook is told how big each object was when it is freed, so remember the
+ * size in a header just before the object. Buffers from gab_egmalloc get the
+ * same header.
+ */
+struct gab_obj *gab_hookalloc(struct gab_triple gab, struct gab_obj *obj,
+                              uint64_t size) {
+  struct gab_eg *eg = gab.eg;
+
+  if (size == 0) {
+    uint64_t *header = (uint64_t *)obj - 1;
+    eg->os_objalloc(eg->os_objalloc_ctx, header, *header + sizeof(uint64_t));
+    return nullptr;
+  }
+
+  uint64_t *header =
+      eg->os_objalloc(eg->os_objalloc_ctx, nullptr, size + sizeof(uint64_t));
+
+  if (header == nullptr)
+    outofmemory(size);
+
+  *header = size;
+  memset(header + 1, 0, size);
+
+  return (struct gab_obj *)(header + 1);
+}
+
+void *gab_egmalloc(struct gab_eg *eg, uint64_t size) {
+  if (eg->os_objalloc == nullptr) {
+    void *ptr = malloc(size);
+
+    if (ptr == nullptr)
+      outofmemory(size);
+
+    return ptr;
+  }
+
+  uint64_t *header =
+      eg->os_objalloc(eg->os_objalloc_ctx, nullptr, size + sizeof(uint64_t));
+
+  if (header == nullptr)
+    outofmemory(size);
+
+  *header = size;
+  return header + 1;
+}
+
+void *gab_egrealloc(struct gab_eg *eg, void *ptr, uint64_t size) {
+  if (eg->os_objalloc == nullptr)
+    return realloc(ptr, size);
+
+  // The hook can't resize, so only move when the block is too small. The
+  // header keeps the size the block was allocated with, for freeing it.
+  if (ptr != nullptr && ((uint64_t *)ptr)[-1] >= size)
+    return ptr;
+
+  uint64_t *header =
+      eg->os_objalloc(eg->os_objalloc_ctx, nullptr, size + sizeof(uint64_t));
+
+  if (header == nullptr)
+    return nullptr;
+
+  *header = size;
+
+  if (ptr != nullptr) {
+    uint64_t old = ((uint64_t *)ptr)[-1];
+    memcpy(header + 1, ptr, old < size ? old : size);
+    gab_egfree(eg, ptr);
+  }
+
+  return header + 1;
+}
+
+void gab_egfree(struct gab_eg *eg, void *ptr) {
+  if (ptr == nullptr)
+    return;
+
+  if (eg->os_objalloc == nullptr)
+    return free(ptr);
+
+  uint64_t *header = (uint64_t *)ptr - 1;
+  eg->os_objalloc(eg->os_objalloc_ctx, header, *header + sizeof(uint64_t));
+}
+
+static void slabs_destroy(struct gab_slabs *slabs) {
+  for (uint64_t c = 0; c < GAB_SLAB_NCLASSES; c++) {
+    struct gab_slab *slab = slabs->head[c];
+
+    while (slab) {
+      struct gab_slab *next = slab->next;
+      free(slab);
+      slab = next;
+    }
+
+    slabs->head[c] = nullptr;
+  }
+
+  mtx_destroy(&slabs->mtx);
+}
+
+void gab_slabdestroy(struct gab_triple gab) {
+  for (uint64_t i = 0; i < gab.eg->len; i++)
+    slabs_destroy(&gab.eg->jobs[i].slabs);
+
+  slabs_destroy(&gab.eg->gcslabs);
+}
+
+/*
+ * Destroy a batch of dead objects. Objects which died together were usually
+ * made together, so their slots are handed back to the slab a run at a time
+ * rather than one by one.
+ */
+static void destroyn(struct gab_triple gab, uint64_t len,
+                     struct gab_obj **objs) {
+#if cGAB_LOG_GC
+  for (uint64_t i = 0; i < len; i++)
+    destroy(gab, objs[i]);
+#else
+  if (gab.eg->objalloc != gab_slaballoc) {
+    for (uint64_t i = 0; i < len; i++)
+      destroy(gab, objs[i]);
+
+    return;
+  }
+
+  struct gab_slab *slab = nullptr;
+  char *first = nullptr, *last = nullptr;
+  uint64_t n = 0;
+
+  for (uint64_t i = 0; i < len; i++) {
+    struct gab_obj *obj = objs[i];
+    assert(obj->references == 0);
+    gab_obj_destroy(gab.eg, obj);
+
+    char *slot = (char *)obj - SLAB_HEADER;
+    struct gab_slab *s = *(struct gab_slab **)slot;
+
+    if (s == nullptr) {
+      free(slot);
+      continue;
+    }
+
+    if (s == slab) {
+      *(void **)(last + SLAB_HEADER) = slot;
+      last = slot;
+      n++;
+      continue;
+    }
+
+    if (slab)
+      slab_freerun(slab, first, last, n);
+
+    slab = s;
+    first = last = slot;
+    n = 1;
+  }
+
+  if (slab)
+    slab_freerun(slab, first, last, n);
+#endif
+}
+
+static uint64_t gcnow() {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/*
+ * Count a pause of the gc job in the histogram.
+ */
+static void gcpause(struct gab_triple gab, uint64_t since_ns) {
+  uint64_t now = gcnow();
+  uint64_t us = now > since_ns ? (now - since_ns) / 1000 : 0;
+
+  uint64_t bucket = us ? 64 - __builtin_clzll(us) : 0;
+  bucket = bucket < GAB_GCNPAUSES ? bucket : GAB_GCNPAUSES - 1;
+
+  atomic_fetch_add_explicit(&gab.eg->gc->pauses[bucket], 1,
+                            memory_order_relaxed);
+}
+
+/*
+ * Give back the slabs which the dead objects emptied, once all of them are
+ * freed - so that a burst of allocation doesn't hold on to its peak for good.
+ */
+static void collect_slabs(struct gab_triple gab) {
+  if (gab.eg->gc->dead.len || gab.eg->objalloc != gab_slaballoc)
+    return;
+
+  for (uint64_t i = 0; i < gab.eg->len; i++)
+    slabs_trim(&gab.eg->jobs[i].slabs);
+
+  slabs_trim(&gab.eg->gcslabs);
+}
+
+/*
+ * Free a slice of the dead objects, within the budget of
+ * cGAB_GC_FREE_BUDGET objects and cGAB_GC_FREE_BUDGET_NS.
+ *
+ * A big structure can die all at once. Freeing it in slices keeps the
+ * collection which found it (and the next one) from waiting on all of it.
+ */
+static void collect_dead(struct gab_triple gab) {
+  v_gab_obj *slice = &gab.eg->gc->dead;
+
+  if (!slice->len)
+    return;
+
+  uint64_t n = slice->len < cGAB_GC_FREE_BUDGET ? slice->len : cGAB_GC_FREE_BUDGET;
+
+  if (n >= cGAB_GC_HELP_MIN && helpstart(gab)) {
+    gab.eg->gc->help.nwork = n;
+    helpshare(gab, kGAB_GCPHASE_FREE);
+    slice->len -= n;
+    return collect_slabs(gab);
+  }
+
+  uint64_t start = gcnow();
+
+  // Reading the clock costs about as much as freeing, so only do it every
+  // so often.
+  while (n) {
+    uint64_t k = n < 64 ? n : 64;
+
+    destroyn(gab, k, slice->data + slice->len - k);
+    slice->len -= k;
+    n -= k;
+
+    if (gcnow() - start >= cGAB_GC_FREE_BUDGET_NS)
+      break;
+  }
+
+  collect_slabs(gab);
+}
+
+bool gab_gcsweep(struct gab_triple gab) {
+  if (!gab.eg->gc->dead.len)
+    return false;
+
+  uint64_t start = gcnow();
+  collect_dead(gab);
+  gcpause(gab, start);
+
+  return gab.eg->gc->dead.len;
+}
+
+uint64_t gab_gcpauses(struct gab_triple gab, uint64_t len, uint64_t *buckets) {
+  len = len < GAB_GCNPAUSES ? len : GAB_GCNPAUSES;
+
+  for (uint64_t i = 0; i < len; i++)
+    buckets[i] = atomic_load_explicit(&gab.eg->gc->pauses[i],
+                                      memory_order_relaxed);
+
+  return len;
+}
+
+void gab_gclock(struct gab_triple gab) {
+  struct gab_jb *wk = gab.eg->jobs + gab.wkid;
+  assert(wk->locked < UINT8_MAX);
+  wk->locked += 1;
+}
+
+/*
+ * There was a bug where objects were beging freed *while they were in the locke
+ * queue*. This was resolved by marking locked objects as *buffered* until they
+ * are unlocked.
+ */
+void gab_gcunlock(struct gab_triple gab) {
+  struct gab_jb *wk = gab.eg->jobs + gab.wkid;
+  assert(wk->locked > 0);
+  wk->locked -= 1;
+
+  if (!wk->locked) {
+    for (uint64_t i = 0; i < wk->lock_keep.len; i++) {
+      struct gab_obj *obj = gab_valtoo(v_gab_value_val_at(&wk->lock_keep, i));
+      gab_gcdrefnew(gab, obj);
+      GAB_OBJ_NOT_BUFFERED(obj);
+    }
+
+    wk->lock_keep.len = 0;
+  }
+}
+
+/*
+ * Whether the pending modifications are worth sharing with helpers. If they
+ * are, their chunks are gathered for helpwork.
+ */
+static bool helpful(struct gab_triple gab, uint8_t b, int32_t epoch) {
+  uint64_t len = 0;
+
+  for (uint8_t wkid = 0; wkid < gab.eg->len; wkid++)
+    len += buflen(gab, kGAB_BUF_STK, wkid, epoch) + buflen(gab, b, wkid, epoch);
+
+  if (len < cGAB_GC_HELP_MIN || !helpstart(gab))
+    return false;
+
+  helpgather(gab, b, epoch);
+  return true;
+}
+
+void processincrements(struct gab_triple gab, int32_t epoch) {
+#if cGAB_LOG_GC
+  printf("IEPOCH\t%i\n", epoch);
+#endif
+
+  if (helpful(gab, kGAB_BUF_INC, epoch)) {
+    helpshare(gab, kGAB_GCPHASE_INC);
+  } else {
+    for (uint8_t wkid = 0; wkid < gab.eg->len; wkid++) {
+      // For the stack and increment buffers, increment the object
+      for_buf_do(kGAB_BUF_STK, wkid, epoch, inc_obj_ref, gab);
+      for_buf_do(kGAB_BUF_INC, wkid, epoch, inc_obj_ref, gab);
+    }
+  }
+
+  // The stack buffers are kept, to be decremented by the next collection.
+  for (uint8_t wkid = 0; wkid < gab.eg->len; wkid++)
+    bufclear(gab, kGAB_BUF_INC, wkid, epoch);
+#if cGAB_LOG_GC
+  printf("IEPOCH!\t%i\n", epoch);
+#endif
 }
 
 void processdecrements(struct gab_triple gab, int32_t epoch) {
@@ -503,10 +1615,34 @@ void processdecrements(struct gab_triple gab, int32_t epoch) {
   printf("DEPOCH\t%i\n", epoch);
 #endif
 
+  if (helpful(gab, kGAB_BUF_DEC, epoch)) {
+    helpshare(gab, kGAB_GCPHASE_DEC);
+
+    // Gather up what the helpers found dead, to be freed with the rest, and
+    // the roots they found for the cycle collector.
+    struct gab_gchelp *h = &gab.eg->gc->help;
+    for (uint64_t i = 0; i < h->nhelpers; i++) {
+      v_gab_obj *hdead = &h->helpers[i].dead;
+      v_gab_obj *hroots = &h->helpers[i].roots;
+
+      for (uint64_t j = 0; j < hdead->len; j++)
+        v_gab_obj_push(&gab.eg->gc->dead, v_gab_obj_val_at(hdead, j));
+
+      for (uint64_t j = 0; j < hroots->len; j++)
+        v_gab_obj_push(&gab.eg->gc->cycles.roots, v_gab_obj_val_at(hroots, j));
+
+      hdead->len = 0;
+      hroots->len = 0;
+    }
+  } else {
+    for (uint8_t wkid = 0; wkid < gab.eg->len; wkid++) {
+      // For the stack and increment buffers, increment the object
+      for_buf_do(kGAB_BUF_STK, wkid, epoch, dec_obj_ref, gab);
+      for_buf_do(kGAB_BUF_DEC, wkid, epoch, dec_buf_ref, gab);
+    }
+  }
+
   for (uint8_t wkid = 0; wkid < gab.eg->len; wkid++) {
-    // For the stack and increment buffers, increment the object
-    for_buf_do(kGAB_BUF_STK, wkid, epoch, dec_obj_ref, gab);
-    for_buf_do(kGAB_BUF_DEC, wkid, epoch, dec_obj_ref, gab);
     // Reset the length of the dec buffer for this worker
     bufclear(gab, kGAB_BUF_STK, wkid, epoch);
     bufclear(gab, kGAB_BUF_DEC, wkid, epoch);
@@ -517,6 +1653,396 @@ void processdecrements(struct gab_triple gab, int32_t epoch) {
 #endif
 }
 
+/*
+ * The trial count of black objects, which are reachable from outside of the
+ * objects being considered. Counts are kept from reaching it otherwise.
+ */
+#define CYC_BLACK INT8_MIN
+
+/*
+ * The trial count of objects which aren't being considered. Objects are made
+ * with it, and it is put back on everything seen once a pass is done.
+ */
+#define CYC_UNSEEN INT8_MAX
+
+/*
+ * The children of an object which the cycle collector follows. Unlike
+ * for_child_do, this includes what is buffered in a channel. The channel may
+ * be in use, so a slot is only read if it was full before and after reading.
+ */
+static void cyc_for_child_do(struct gab_obj *obj, gab_gc_visitor fnc,
+                             struct gab_triple gab) {
+  for_child_do(obj, fnc, gab);
+
+  if (obj->kind != kGAB_CHANNEL && obj->kind != kGAB_CHANNELCLOSED)
+    return;
+
+  struct gab_obj_channel *chn = (struct gab_obj_channel *)obj;
+
+  if (!chn->len)
+    return;
+
+  uint64_t head = atomic_load_explicit(&chn->head, memory_order_acquire);
+  uint64_t tail = atomic_load_explicit(&chn->tail, memory_order_acquire);
+
+  for (uint64_t pos = head; pos < tail; pos++) {
+    struct gab_chnslot *slot = chn->buffer + pos % chn->len;
+
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != pos + 1)
+      continue;
+
+    gab_value v = slot->value;
+
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&slot->seq, memory_order_relaxed) != pos + 1)
+      continue;
+
+    if (gab_valiso(v))
+      fnc(gab, gab_valtoo(v));
+  }
+}
+
+/*
+ * Whether the cycle collector should consider an object at all. New objects
+ * haven't counted their children yet, and buffered ones are dead or locked.
+ */
+static inline bool cyc_scoped(struct gab_triple gab, struct gab_obj *obj) {
+  if (!cyc_kind(obj))
+    return false;
+
+  if (atomic_load_explicit(&obj->flags, memory_order_relaxed) &
+      (fGAB_OBJ_NEW | fGAB_OBJ_BUFFERED | fGAB_OBJ_ACYCLIC |
+       fGAB_OBJ_IMMORTAL))
+    return false;
+
+  uint8_t rc = atomic_load_explicit(&obj->references, memory_order_relaxed);
+
+  if (rc == 0 || rc == INT8_MAX)
+    return false;
+
+  // The engine holds on to its messages for as long as it lives.
+  return __gab_obj(obj) != gab.eg->messages;
+}
+
+static inline bool cyc_isgray(struct gab_obj *obj) {
+  return obj->trial != CYC_UNSEEN;
+}
+
+/*
+ * Start considering an object, with its whole count.
+ */
+static inline void cyc_see(struct gab_gccycles *c, struct gab_obj *obj,
+                           int8_t trial) {
+  obj->trial = trial;
+  v_gab_obj_push(&c->seen, obj);
+}
+
+/*
+ * Stop considering everything which was seen by the last pass.
+ */
+static void cyc_clear(struct gab_gccycles *c) {
+  for (uint64_t i = 0; i < c->seen.len; i++)
+    v_gab_obj_val_at(&c->seen, i)->trial = CYC_UNSEEN;
+
+  c->seen.len = 0;
+  c->stack.len = 0;
+}
+
+static void cyc_acyclic_child(struct gab_triple gab, struct gab_obj *obj) {
+  struct gab_gccycles *c = &gab.eg->gc->cycles;
+
+  if (!cyc_kind(obj))
+    return;
+
+  uint8_t flags = atomic_load_explicit(&obj->flags, memory_order_relaxed);
+
+  // An immortal object is never garbage, so no cycle through it is either.
+  if (flags & (fGAB_OBJ_ACYCLIC | fGAB_OBJ_IMMORTAL))
+    return;
+
+  if (!cyc_immutable(obj) || (flags & fGAB_OBJ_NEW)) {
+    c->fail = true;
+    return;
+  }
+
+  v_gab_obj_push(&c->stack, obj);
+}
+
+/*
+ * Whether an immutable object can never be part of a cycle, because nothing
+ * it refers to can be changed to refer back to it. The answer never changes,
+ * so it is remembered in the object (and everything under it) for next time.
+ */
+static bool cyc_acyclic(struct gab_triple gab, struct gab_obj *root) {
+  struct gab_gccycles *c = &gab.eg->gc->cycles;
+
+  c->fail = false;
+  v_gab_obj_push(&c->stack, root);
+
+  uint64_t n = 0;
+  while (c->stack.len && !c->fail) {
+    uintptr_t top = (uintptr_t)v_gab_obj_pop(&c->stack);
+
+    // All of a marked object's children have been found acyclic.
+    if (top & 1) {
+      atomic_fetch_or_explicit(&((struct gab_obj *)(top & ~1))->flags,
+                               fGAB_OBJ_ACYCLIC, memory_order_relaxed);
+      continue;
+    }
+
+    struct gab_obj *obj = (struct gab_obj *)top;
+
+    if (atomic_load_explicit(&obj->flags, memory_order_relaxed) &
+        fGAB_OBJ_ACYCLIC)
+      continue;
+
+    if (n++ >= cGAB_GC_CYCLE_BUDGET)
+      c->fail = true;
+
+    v_gab_obj_push(&c->stack, (struct gab_obj *)(top | 1));
+    for_child_do(obj, cyc_acyclic_child, gab);
+  }
+
+  c->stack.len = 0;
+  return !c->fail;
+}
+
+/*
+ * Subtract a reference from inside the objects being considered from an
+ * object's trial count.
+ */
+static void cyc_gray(struct gab_triple gab, struct gab_obj *obj) {
+  struct gab_gccycles *c = &gab.eg->gc->cycles;
+
+  if (!cyc_isgray(obj)) {
+    if (!cyc_scoped(gab, obj))
+      return;
+
+    // Leaving an object out only leaves its count higher.
+    if (c->seen.len >= c->budget)
+      return;
+
+    cyc_see(c, obj, obj->references);
+    v_gab_obj_push(&c->stack, obj);
+  }
+
+  if (obj->trial > CYC_BLACK + 1)
+    obj->trial--;
+}
+
+static void cyc_markgray(struct gab_triple gab, struct gab_obj *root) {
+  struct gab_gccycles *c = &gab.eg->gc->cycles;
+
+  if (cyc_isgray(root))
+    return;
+
+  cyc_see(c, root, root->references);
+  v_gab_obj_push(&c->stack, root);
+
+  while (c->stack.len)
+    cyc_for_child_do(v_gab_obj_pop(&c->stack), cyc_gray, gab);
+}
+
+static void cyc_black(struct gab_triple gab, struct gab_obj *obj) {
+  struct gab_gccycles *c = &gab.eg->gc->cycles;
+
+  if (!cyc_isgray(obj) || obj->trial == CYC_BLACK)
+    return;
+
+  obj->trial = CYC_BLACK;
+  v_gab_obj_push(&c->stack, obj);
+}
+
+/*
+ * Anything with references from outside of the objects considered is alive,
+ * and so is everything it refers to.
+ */
+static void cyc_scan(struct gab_triple gab) {
+  struct gab_gccycles *c = &gab.eg->gc->cycles;
+
+  for (uint64_t i = 0; i < c->seen.len; i++) {
+    struct gab_obj *obj = v_gab_obj_val_at(&c->seen, i);
+
+    if (obj->trial == 0 || obj->trial == CYC_BLACK)
+      continue;
+
+    cyc_black(gab, obj);
+
+    while (c->stack.len)
+      cyc_for_child_do(v_gab_obj_pop(&c->stack), cyc_black, gab);
+  }
+}
+
+/*
+ * Look for garbage cycles under the candidate roots, for as long as the
+ * budget lasts. Whatever is left is looked at by the next collection.
+ */
+static void cyc_collectroots(struct gab_triple gab) {
+  struct gab_gccycles *c = &gab.eg->gc->cycles;
+
+  // Keep up with however many roots are waiting.
+  c->budget = c->roots.len * 2;
+  c->budget = c->budget > cGAB_GC_CYCLE_BUDGET ? c->budget : cGAB_GC_CYCLE_BUDGET;
+
+  while (c->roots.len && c->seen.len < c->budget) {
+    struct gab_obj *obj = v_gab_obj_pop(&c->roots);
+
+    atomic_fetch_and_explicit(&obj->flags, ~fGAB_OBJ_ROOT,
+                              memory_order_relaxed);
+
+    // The object died while it was a root, and was left for us to free.
+    if (obj->references == 0) {
+      v_gab_obj_push(dead, obj);
+      continue;
+    }
+
+    if (!cyc_scoped(gab, obj))
+      continue;
+
+    if (cyc_immutable(obj) && cyc_acyclic(gab, obj))
+      continue;
+
+    cyc_markgray(gab, obj);
+  }
+
+  cyc_scan(gab);
+
+  // What's left is only referenced from inside of itself. An object which is
+  // still waiting as a root is left out, which fails the next collection's
+  // check and puts the rest back as roots.
+  for (uint64_t i = 0; i < c->seen.len; i++) {
+    struct gab_obj *obj = v_gab_obj_val_at(&c->seen, i);
+
+    if (obj->trial != 0)
+      continue;
+
+    if (atomic_load_explicit(&obj->flags, memory_order_relaxed) &
+        fGAB_OBJ_ROOT)
+      continue;
+
+    atomic_fetch_or_explicit(&obj->flags, fGAB_OBJ_CYCLIC,
+                             memory_order_relaxed);
+    v_gab_obj_push(&c->white, obj);
+  }
+
+#if cGAB_LOG_GC
+  printf("CYCLES\t%i\t%lu\t%lu\n", epochget(gab), c->seen.len, c->white.len);
+#endif
+
+  cyc_clear(c);
+}
+
+static void cyc_sigma(struct gab_triple gab, struct gab_obj *obj) {
+  if (cyc_isgray(obj) && obj->trial > CYC_BLACK + 1)
+    obj->trial--;
+}
+
+static void cyc_release(struct gab_triple gab, struct gab_obj *obj) {
+  if (!(atomic_load_explicit(&obj->flags, memory_order_relaxed) &
+        fGAB_OBJ_CYCLIC))
+    dec_obj_ref(gab, obj);
+}
+
+/*
+ * The cycles found by the last collection were found while the workers kept
+ * running, so they may have been wrong. Any part of them which a worker has
+ * changed the count of since is alive. Of the rest, only the part which is
+ * still only referenced by itself is garbage.
+ */
+static void cyc_confirm(struct gab_triple gab) {
+  struct gab_gccycles *c = &gab.eg->gc->cycles;
+
+  if (!c->white.len)
+    return;
+
+  for (uint64_t i = 0; i < c->white.len; i++) {
+    struct gab_obj *obj = v_gab_obj_val_at(&c->white, i);
+    uint8_t rc = atomic_load_explicit(&obj->references, memory_order_relaxed);
+
+    bool changed = rc == 0 || rc == INT8_MAX ||
+                   (atomic_load_explicit(&obj->flags, memory_order_relaxed) &
+                    fGAB_OBJ_TOUCHED);
+
+    cyc_see(c, obj, changed ? CYC_BLACK : rc);
+  }
+
+  for (uint64_t i = 0; i < c->white.len; i++) {
+    struct gab_obj *obj = v_gab_obj_val_at(&c->white, i);
+
+    if (obj->trial != CYC_BLACK)
+      cyc_for_child_do(obj, cyc_sigma, gab);
+  }
+
+  // An object which changed may have lost its references to the rest, so
+  // nothing can be subtracted for it. Instead, it (and everything it refers
+  // to) is alive.
+  for (uint64_t i = 0; i < c->white.len; i++) {
+    struct gab_obj *obj = v_gab_obj_val_at(&c->white, i);
+
+    if (obj->trial != CYC_BLACK || obj->references == 0)
+      continue;
+
+    v_gab_obj_push(&c->stack, obj);
+    while (c->stack.len)
+      cyc_for_child_do(v_gab_obj_pop(&c->stack), cyc_black, gab);
+  }
+
+  cyc_scan(gab);
+
+  uint64_t ngarbage = 0;
+
+  // Let go of what is alive first, so that releasing the garbage treats it
+  // like any other object.
+  for (uint64_t i = 0; i < c->white.len; i++) {
+    struct gab_obj *obj = v_gab_obj_val_at(&c->white, i);
+
+    if (obj->trial == 0) {
+      atomic_store_explicit(&obj->references, 0, memory_order_relaxed);
+      atomic_fetch_or_explicit(&obj->flags, fGAB_OBJ_BUFFERED,
+                               memory_order_relaxed);
+      v_gab_obj_set(&c->white, ngarbage++, obj);
+      continue;
+    }
+
+    uint8_t flags = atomic_fetch_and_explicit(
+        &obj->flags, ~(fGAB_OBJ_CYCLIC | fGAB_OBJ_TOUCHED),
+        memory_order_relaxed);
+
+    // Objects which died in the meantime were left for us to free, unless
+    // they are also waiting as a root.
+    if (obj->references)
+      cyc_record(obj);
+    else if (!(flags & fGAB_OBJ_ROOT))
+      v_gab_obj_push(dead, obj);
+  }
+
+  cyc_clear(c);
+
+#if cGAB_LOG_GC
+  printf("CYCLE\t%i\t%lu\t%lu\n", epochget(gab), c->white.len, ngarbage);
+#endif
+
+  c->white.len = ngarbage;
+
+  // Release what the garbage refers to outside of itself.
+  for (uint64_t i = 0; i < c->white.len; i++)
+    cyc_for_child_do(v_gab_obj_val_at(&c->white, i), cyc_release, gab);
+
+  for (uint64_t i = 0; i < c->white.len; i++) {
+    struct gab_obj *obj = v_gab_obj_val_at(&c->white, i);
+    atomic_fetch_and_explicit(&obj->flags, ~fGAB_OBJ_CYCLIC,
+                              memory_order_relaxed);
+    v_gab_obj_push(dead, obj);
+  }
+
+  c->white.len = 0;
+}
+
+static void collect_cycles(struct gab_triple gab) {
+  cyc_confirm(gab);
+  cyc_collectroots(gab);
+}
+
 void processepoch(struct gab_triple gab, int32_t e) {
   struct gab_jb *wk = &gab.eg->jobs[gab.wkid];
 
@@ -537,14 +2063,20 @@ void processepoch(struct gab_triple gab, int32_t e) {
 
   uint64_t stack_size = vm->sp - vm->sb;
 
-  assert(stack_size + wk->lock_keep.len + 2 < cGAB_GC_MOD_BUFF_MAX);
-
   bufpush(gab, kGAB_BUF_STK, gab.wkid, e, gab_valtoo(wk->fiber));
-  bufpush(gab, kGAB_BUF_STK, gab.wkid, e, gab_valtoo(fb->messages));
+
+  // Immortal objects are left out - saving them would only be counting them
+  // up and back down again.
+  if (!GAB_OBJ_IS_IMMORTAL(gab_valtoo(fb->messages)))
+    bufpush(gab, kGAB_BUF_STK, gab.wkid, e, gab_valtoo(fb->messages));
 
   for (uint64_t i = 0; i < stack_size; i++) {
     if (gab_valiso(vm->sb[i])) {
       struct gab_obj *o = gab_valtoo(vm->sb[i]);
+
+      if (GAB_OBJ_IS_IMMORTAL(o))
+        continue;
+
 #if cGAB_LOG_GC
       printf("SAVESTK\t%i\t%p\t%d\n", epochget(gab), (void *)o, o->kind);
 #endif
@@ -585,6 +2117,7 @@ void schedule(struct gab_triple gab, uint64_t wkid) {
 #endif
 
     gab.eg->gc->schedule = 0;
+    gab_unpark(&gab.eg->jobs[0].parker);
     return;
   }
 
@@ -600,8 +2133,24 @@ void schedule(struct gab_triple gab, uint64_t wkid) {
     return;
   }
 
-  if (gab.eg->gc->schedule < (int8_t)wkid)
-    gab.eg->gc->schedule = wkid;
+  if (gab.eg->gc->schedule >= (int8_t)wkid)
+    return;
+
+  gab.eg->gc->schedule = wkid;
+
+  // The worker may be asleep, waiting for work.
+  gab_unpark(&gab.eg->jobs[wkid].parker);
+
+  // The worker may also have exited since we checked. Either it sees that
+  // it was scheduled and revives itself, or we see that it's gone and skip
+  // it. Claim the job while skipping, so it isn't revived halfway through.
+  bool dead = false;
+  if (!gab.eg->jobs[wkid].alive &&
+      atomic_compare_exchange_strong(&gab.eg->jobs[wkid].alive, &dead, true)) {
+    gab.eg->jobs[wkid].epoch++;
+    gab.eg->jobs[wkid].alive = false;
+    schedule(gab, wkid + 1);
+  }
 }
 
 #if cGAB_LOG_GC
@@ -642,11 +2191,16 @@ bool gab_gctrigger(struct gab_triple gab) {
 void gab_gcdocollect(struct gab_triple gab) {
   assert(gab.wkid == 0);
 
+  uint64_t start = gcnow();
+
   int32_t epoch = epochget(gab);
   int32_t last = epochgetlast(gab);
 
   assert(epoch != last);
 
+  dead = &gab.eg->gc->dead;
+  roots = &gab.eg->gc->cycles.roots;
+
   processepoch(gab, epoch);
 
 #if cGAB_LOG_GC
@@ -656,6 +2210,10 @@ void gab_gcdocollect(struct gab_triple gab) {
   assert_workers_have_epoch(gab, expected_e);
 #endif
 
+  gab_value dispatched = gab_dispatchepoch(gab);
+  if (gab_valiso(dispatched))
+    inc_obj_ref(gab, gab_valtoo(dispatched));
+
   if (gab_valiso(gab.eg->messages))
     inc_obj_ref(gab, gab_valtoo(gab.eg->messages));
 
@@ -666,6 +2224,8 @@ void gab_gcdocollect(struct gab_triple gab) {
 
   processdecrements(gab, last);
 
+  collect_cycles(gab);
+
   collect_dead(gab);
 
 #if cGAB_LOG_GC
@@ -674,13 +2234,19 @@ void gab_gcdocollect(struct gab_triple gab) {
   assert_workers_have_epoch(gab, expected_e);
 #endif
 
+  if (gab_valiso(dispatched))
+    queue_decrement(gab, gab_valtoo(dispatched));
+
   if (gab_valiso(gab.eg->messages))
     queue_decrement(gab, gab_valtoo(gab.eg->messages));
 
   if (gab_valiso(gab.eg->shapes))
     queue_decrement(gab, gab_valtoo(gab.eg->shapes));
 
+  gcpause(gab, start);
+
   gab.eg->gc->schedule = -1;
+  gab_wlnotify(&gab.eg->lifecycle);
 }
 
 void gab_collect(struct gab_triple gab) {
@@ -17,8 +17,9 @@ struct gab_obj *gab_obj_create(struct gab_triple gab, uint64_t sz,
   struct gab_obj *self = gab_egalloc(gab, nullptr, sz);
 
   self->kind = k;
-  self->references = 1;
-  self->flags = fGAB_OBJ_NEW;
+  self->trial = INT8_MAX;
+  atomic_init(&self->references, 1);
+  atomic_init(&self->flags, fGAB_OBJ_NEW | fGAB_OBJ_FRESH);
 
 #if cGAB_LOG_GC
   printf("CREATE\t%p\t%lu\t%d\n", (void *)self, sz, k);
@@ -32,7 +33,7 @@ struct gab_obj *gab_obj_create(struct gab_triple gab, uint64_t sz,
     printf("QLOCK\t%p\n", (void *)self);
 #endif
   } else {
-    gab_dref(gab, __gab_obj(self));
+    gab_gcdrefnew(gab, self);
   }
 
   return self;
@@ -41,7 +42,10 @@ struct gab_obj *gab_obj_create(struct gab_triple gab, uint64_t sz,
 uint64_t gab_obj_size(struct gab_obj *obj) {
   switch (obj->kind) {
   case kGAB_CHANNEL:
-    return sizeof(struct gab_obj_channel);
+  case kGAB_CHANNELCLOSED: {
+    struct gab_obj_channel *o = (struct gab_obj_channel *)obj;
+    return sizeof(struct gab_obj_channel) + o->len * sizeof(struct gab_chnslot);
+  }
   case kGAB_BOX: {
     struct gab_obj_box *o = (struct gab_obj_box *)obj;
     return sizeof(struct gab_obj_box) + o->len * sizeof(char);
@@ -69,10 +73,22 @@ uint64_t gab_obj_size(struct gab_obj *obj) {
   }
   case kGAB_STRING: {
     struct gab_obj_string *o = (struct gab_obj_string *)obj;
+
+    if (o->rep == kGAB_STRREP_BUILDER)
+      return sizeof(struct gab_obj_strbuilder);
+
+    if (o->rep == kGAB_STRREP_SLICE)
+      return sizeof(struct gab_obj_strslice);
+
     return sizeof(struct gab_obj_string) + (o->len + 1) * sizeof(char);
   }
   case kGAB_FIBER:
-    return sizeof(struct gab_obj_fiber);
+  case kGAB_FIBERRUNNING:
+  case kGAB_FIBERDONE: {
+    struct gab_obj_fiber *o = (struct gab_obj_fiber *)obj;
+    return sizeof(struct gab_obj_fiber) + o->len * sizeof(gab_value) +
+           o->vm.cap * sizeof(gab_value);
+  }
   case kGAB_NATIVE:
     return sizeof(struct gab_obj_native);
   default:
@@ -269,12 +285,34 @@ int gab_fvalinspect(FILE *stream, gab_value self, int depth) {
 
 void gab_obj_destroy(struct gab_eg *gab, struct gab_obj *self) {
   switch (self->kind) {
+  case kGAB_FIBER:
+  case kGAB_FIBERRUNNING: {
+    struct gab_obj_fiber *fib = (struct gab_obj_fiber *)self;
+    gab_wldestroy(&fib->waiters);
+    gab_egfree(gab, fib->vm.sb);
+    break;
+  }
   case kGAB_FIBERDONE: {
     struct gab_obj_fiber *fib = (struct gab_obj_fiber *)self;
     assert(fib->res);
     a_gab_value_destroy(fib->res);
+    gab_wldestroy(&fib->waiters);
+    gab_egfree(gab, fib->vm.sb);
     break;
   };
+  case kGAB_CHANNEL:
+  case kGAB_CHANNELCLOSED: {
+    struct gab_obj_channel *chn = (struct gab_obj_channel *)self;
+    gab_wldestroy(&chn->takers);
+    gab_wldestroy(&chn->putters);
+
+    // Fibers still in line were deadlocked, and are released by gab_destroy.
+    for (uint64_t i = 0; i < kGAB_CHNWAIT_NKINDS; i++)
+      v_gab_value_destroy(&chn->parked[i].fibers);
+
+    mtx_destroy(&chn->mtx);
+    break;
+  }
   case kGAB_SHAPE:
   case kGAB_SHAPELIST: {
     struct gab_obj_shape *shp = (struct gab_obj_shape *)self;
@@ -287,17 +325,46 @@ void gab_obj_destroy(struct gab_eg *gab, struct gab_obj *self) {
       box->do_destroy(box->len, box->data);
     break;
   }
-  case kGAB_STRING:
-    mtx_lock(&gab->strings_mtx);
-    printf("STRFREE %p\n", self);
+  case kGAB_STRING: {
+    struct gab_obj_string *str = (struct gab_obj_string *)self;
+
+    if (str->rep == kGAB_STRREP_LARGE)
+      break;
+
+    if (str->rep == kGAB_STRREP_SLICE) {
+      struct gab_obj_strslice *sl = (struct gab_obj_strslice *)self;
+
+      if (!sl->borrowed)
+        gab_egfree(gab, sl->flat);
+
+      break;
+    }
+
+    if (str->rep == kGAB_STRREP_BUILDER) {
+      struct gab_obj_strbuilder *sb = (struct gab_obj_strbuilder *)self;
+
+      if (sb->flat != sb->buf->data)
+        gab_egfree(gab, sb->flat);
+
+      if (atomic_fetch_sub(&sb->buf->rc, 1) == 1)
+        gab_egfree(gab, sb->buf);
+
+      break;
+    }
+
     /*
-     * ASYNC ISSUE: Because collections happen asynchronously (and the strings intern table *doesn't hold references)
-     * Strings that are queued for removal *can* be re-used *right* before they are deleted. This requires a better, long-term
-     * solution.
+     * Lookups skip a string once its count reaches zero, and take their
+     * reference with a CAS which fails from zero. So nothing can have picked
+     * this string up since it died. The table compares keys by identity, so a
+     * newer string with the same contents is left alone.
      */
-    d_strings_remove(&gab->strings, (struct gab_obj_string *)self);
-    mtx_unlock(&gab->strings_mtx);
+    struct gab_strshard *shard = gab_egstrshard(gab, str->hash);
+
+    mtx_lock(&shard->mtx);
+    d_strings_remove(&shard->strings, str);
+    mtx_unlock(&shard->mtx);
     break;
+  }
   default:
     break;
   }
@@ -353,41 +420,289 @@ gab_value nstring(struct gab_triple gab, uint64_t hash, uint64_t len,
       GAB_CREATE_FLEX_OBJ(gab_obj_string, char, str.len + 1, kGAB_STRING);
 
   memcpy(self->data, str.data, str.len);
+  self->rep = kGAB_STRREP_INTERNED;
   self->len = str.len;
   self->hash = hash;
 
-  /* The strings table should hold a reference to this string */
-  /* This does mean that strings will never die */
-  d_strings_insert(&gab.eg->strings, self, 0);
-  gab_iref(gab, __gab_obj(self));
+  /* The strings table doesn't hold a reference, a string leaves when freed */
+  d_strings_insert(&gab_egstrshard(gab.eg, hash)->strings, self, 0);
 
   return __gab_obj(self);
 }
 
-gab_value gab_nstring(struct gab_triple gab, uint64_t len, const char *data) {
-  if (len <= 5)
-    return gab_shorstr(len, data);
+/*
+ * The slot in this job's string cache for the hash, or nullptr if the caller
+ * isn't running in a job. The cache is emptied whenever the job's epoch has
+ * moved on, as the strings in it may have died since.
+ */
+static inline struct gab_obj_string **strcache(struct gab_triple gab,
+                                               uint64_t hash) {
+  // The gc job's slot is shared by every caller outside of a job.
+  if (gab.wkid == 0)
+    return nullptr;
 
-  mtx_lock(&gab.eg->strings_mtx);
+  struct gab_jb *wk = gab.eg->jobs + gab.wkid;
+  uint32_t epoch = atomic_load_explicit(&wk->epoch, memory_order_relaxed);
 
-#if cGAB_STRING_HASHLEN > 0
-  uint64_t hash =
-      hash_bytes(len < cGAB_STRING_HASHLEN ? len : cGAB_STRING_HASHLEN,
-                 (unsigned char *)data);
-#else
-  uint64_t hash = hash_bytes(len, (unsigned char *)data);
-#endif
+  if (__gab_unlikely(wk->strcache_epoch != epoch)) {
+    memset(wk->strcache, 0, sizeof(wk->strcache));
+    wk->strcache_epoch = epoch;
+  }
+
+  return wk->strcache + (hash & (cGAB_STRING_CACHE_LEN - 1));
+}
+
+/*
+ * Intern the string, taking a reference to an existing one if it is still
+ * alive.
+ */
+static gab_value intern(struct gab_triple gab, uint64_t hash, uint64_t len,
+                        const char *data) {
+  struct gab_obj_string **slot = strcache(gab, hash);
+
+  if (slot && *slot && (*slot)->hash == hash && (*slot)->len == len &&
+      !memcmp((*slot)->data, data, len))
+    return __gab_obj(*slot);
+
+  struct gab_strshard *shard = gab_egstrshard(gab.eg, hash);
+
+  mtx_lock(&shard->mtx);
 
   struct gab_obj_string *interned = gab_egstrfind(gab.eg, hash, len, data);
 
-  if (interned)
-    return mtx_unlock(&gab.eg->strings_mtx), __gab_obj(interned);
+  gab_value result = interned && gab_gcweakref(gab, &interned->header)
+                         ? __gab_obj(interned)
+                         : nstring(gab, hash, len, data);
+
+  mtx_unlock(&shard->mtx);
 
-  gab_value s = nstring(gab, hash, len, data);
+  if (slot)
+    *slot = GAB_VAL_TO_STRING(result);
+
+  return result;
+}
+
+/*
+ * A string which is too long to be worth interning. It is hashed the first time
+ * something asks (see gab_strlazyhash).
+ */
+static gab_value largestring(struct gab_triple gab, uint64_t len,
+                             const char *data) {
+  struct gab_obj_string *self =
+      GAB_CREATE_FLEX_OBJ(gab_obj_string, char, len + 1, kGAB_STRING);
 
-  return mtx_unlock(&gab.eg->strings_mtx), s;
+  memcpy(self->data, data, len);
+  self->data[len] = '\0';
+  self->rep = kGAB_STRREP_LARGE;
+  self->len = len;
+
+  return __gab_obj(self);
+}
+
+gab_value gab_ninterned(struct gab_triple gab, uint64_t len, const char *data) {
+  if (len <= 5)
+    return gab_shorstr(len, data);
+
+  uint64_t hash = hash_bytes(gab.eg->hash_seed, len, (uint8_t *)data);
+
+  return intern(gab, hash, len, data);
+}
+
+gab_value gab_nstring(struct gab_triple gab, uint64_t len, const char *data) {
+  if (len >= cGAB_STRING_LARGE_MIN)
+    return largestring(gab, len, data);
+
+  return gab_ninterned(gab, len, data);
 };
 
+static gab_value strbuilder(struct gab_triple gab, struct gab_strbuf *buf,
+                            uint64_t len) {
+  struct gab_obj_strbuilder *self =
+      GAB_CREATE_OBJ(gab_obj_strbuilder, kGAB_STRING);
+
+  atomic_fetch_add(&buf->rc, 1);
+
+  self->rep = kGAB_STRREP_BUILDER;
+  self->len = len;
+  self->buf = buf;
+
+  return __gab_obj(self);
+}
+
+/*
+ * Concatenate into a builder string. If a is a builder which ends at the end
+ * of its buffer, b is appended to that buffer in place. Otherwise both are
+ * copied into a new buffer, with room to append as much again.
+ */
+static gab_value strbuild(struct gab_triple gab, gab_value a, gab_value b) {
+  uint64_t alen = gab_strlen(a);
+  uint64_t blen = gab_strlen(b);
+  uint64_t len = alen + blen;
+
+  if (gab_valiso(a) && GAB_VAL_TO_STRING(a)->rep == kGAB_STRREP_BUILDER) {
+    struct gab_strbuf *buf = GAB_VAL_TO_STRBUILDER(a)->buf;
+    uint64_t end = alen;
+
+    // Leave room for a null terminator (see gab_strflat).
+    if (len < buf->cap && atomic_compare_exchange_strong(&buf->len, &end, len)) {
+      // If b shares this buffer, it ends at or before the end of a - so it
+      // doesn't overlap with where it is copied to.
+      memcpy(buf->data + alen, gab_strbytes(&b), blen);
+      return strbuilder(gab, buf, len);
+    }
+  }
+
+  uint64_t cap = len * 2;
+
+  struct gab_strbuf *buf =
+      gab_egmalloc(gab.eg, sizeof(struct gab_strbuf) + cap);
+  atomic_init(&buf->rc, 0);
+  atomic_init(&buf->len, len);
+  buf->cap = cap;
+  buf->eg = gab.eg;
+
+  memcpy(buf->data, gab_strbytes(&a), alen);
+  memcpy(buf->data + alen, gab_strbytes(&b), blen);
+
+  return strbuilder(gab, buf, len);
+}
+
+/*
+ * Null-terminated bytes for a builder string.
+ */
+static char *builderflat(struct gab_obj_strbuilder *self) {
+  struct gab_strbuf *buf = self->buf;
+  uint64_t end = self->len;
+
+  // Claim the byte after this string for its terminator, unless the buffer
+  // already goes on past it. Nothing can be appended to it after this.
+  if (self->len < buf->cap &&
+      atomic_compare_exchange_strong(&buf->len, &end, self->len + 1)) {
+    buf->data[self->len] = '\0';
+    return buf->data;
+  }
+
+  return nullptr;
+}
+
+/*
+ * Null-terminated bytes for a slice, if it borrows them from its parent.
+ */
+static char *sliceflat(struct gab_obj_strslice *self) {
+  if (!self->borrowed)
+    return nullptr;
+
+  return GAB_VAL_TO_STRING(self->parent)->data + self->offset;
+}
+
+const char *gab_strflat(struct gab_obj_string *str) {
+  assert(str->rep == kGAB_STRREP_BUILDER || str->rep == kGAB_STRREP_SLICE);
+
+  char *_Atomic *slot = str->rep == kGAB_STRREP_BUILDER
+                            ? &((struct gab_obj_strbuilder *)str)->flat
+                            : &((struct gab_obj_strslice *)str)->flat;
+
+  char *flat = atomic_load(slot);
+  if (flat)
+    return flat;
+
+  const char *bytes = __gab_strbytes(str);
+
+  flat = str->rep == kGAB_STRREP_BUILDER
+             ? builderflat((struct gab_obj_strbuilder *)str)
+             : sliceflat((struct gab_obj_strslice *)str);
+
+  struct gab_eg *eg = str->rep == kGAB_STRREP_BUILDER
+                         ? ((struct gab_obj_strbuilder *)str)->buf->eg
+                         : ((struct gab_obj_strslice *)str)->eg;
+
+  if (!flat) {
+    flat = gab_egmalloc(eg, str->len + 1);
+    memcpy(flat, bytes, str->len);
+    flat[str->len] = '\0';
+  }
+
+  char *expected = nullptr;
+  if (atomic_compare_exchange_strong(slot, &expected, flat))
+    return flat;
+
+  // Another thread got here first.
+  if (flat != bytes)
+    gab_egfree(eg, flat);
+
+  return expected;
+}
+
+gab_value gab_strslice(struct gab_triple gab, gab_value str, uint64_t offset,
+                       uint64_t len) {
+  assert(gab_valkind(str) == kGAB_STRING);
+
+  uint64_t strlen = gab_strlen(str);
+
+  offset = offset >= strlen ? strlen : offset;
+  len = offset + len > strlen ? strlen - offset : len;
+
+  if (offset == 0 && len == strlen)
+    return str;
+
+  // Parts of interned strings are small enough to copy, and short ones fit
+  // in the value itself.
+  if (len <= 5 || gab_valisinterned(str))
+    return gab_nstring(gab, len, gab_strbytes(&str) + offset);
+
+  struct gab_obj_string *s = GAB_VAL_TO_STRING(str);
+
+  // Borrow from the string the slice is a part of, so that slices don't
+  // chain.
+  if (s->rep == kGAB_STRREP_SLICE) {
+    offset += GAB_VAL_TO_STRSLICE(str)->offset;
+    str = GAB_VAL_TO_STRSLICE(str)->parent;
+  }
+
+  struct gab_obj_strslice *self = GAB_CREATE_OBJ(gab_obj_strslice, kGAB_STRING);
+
+  self->rep = kGAB_STRREP_SLICE;
+  self->len = len;
+  self->parent = str;
+  self->offset = offset;
+  self->eg = gab.eg;
+
+  // Only these keep a null terminator after their bytes, so a slice which
+  // ends where one of them does can use them as they are.
+  struct gab_obj_string *parent = GAB_VAL_TO_STRING(str);
+  self->borrowed = (parent->rep == kGAB_STRREP_INTERNED ||
+                    parent->rep == kGAB_STRREP_LARGE) &&
+                   offset + len == parent->len;
+
+  return __gab_obj(self);
+}
+
+uint64_t gab_strlazyhash(struct gab_triple gab, struct gab_obj_string *str) {
+  uint64_t hash = atomic_load_explicit(&str->hash, memory_order_relaxed);
+
+  if (hash)
+    return hash;
+
+  hash = hash_bytes(gab.eg->hash_seed, str->len,
+                    (const uint8_t *)__gab_strbytes(str));
+
+  atomic_store_explicit(&str->hash, hash, memory_order_relaxed);
+  return hash;
+}
+
+gab_value gab_valintern(struct gab_triple gab, gab_value value) {
+  if (gab_valisinterned(value))
+    return value;
+
+  struct gab_obj_string *str = GAB_VAL_TO_STRING(value);
+  uint64_t tag = value & __GAB_TAGBITS;
+
+  gab_value s = intern(gab, gab_strlazyhash(gab, str), str->len,
+                       __gab_strbytes(str));
+
+  return s | tag;
+}
+
 /*
   Given two strings, create a third which is the concatenation a+b
 */
@@ -409,20 +724,17 @@ gab_value gab_strcat(struct gab_triple gab, gab_value _a, gab_value _b) {
   if (len <= 5)
     return gab_shortstrcat(_a, _b);
 
+  if (len >= cGAB_STRING_BUILDER_MIN)
+    return strbuild(gab, _a, _b);
+
   a_char *buff = a_char_empty(len + 1);
 
   // Copy the data into the string obj.
-  memcpy(buff->data, gab_strdata(&_a), alen);
-  memcpy(buff->data + alen, gab_strdata(&_b), blen);
+  memcpy(buff->data, gab_strbytes(&_a), alen);
+  memcpy(buff->data + alen, gab_strbytes(&_b), blen);
 
 // Pre compute the hash
-#if cGAB_STRING_HASHLEN > 0
-  uint64_t hash =
-      hash_bytes(len < cGAB_STRING_HASHLEN ? len : cGAB_STRING_HASHLEN,
-                 (unsigned char *)buff->data);
-#else
-  uint64_t hash = hash_bytes(len, (unsigned char *)buff->data);
-#endif
+  uint64_t hash = hash_bytes(gab.eg->hash_seed, len, (uint8_t *)buff->data);
 
   /*
     If this string was interned already, return.
@@ -430,20 +742,11 @@ gab_value gab_strcat(struct gab_triple gab, gab_value _a, gab_value _b) {
     Unfortunately, we can't check for this before copying and computing the
     hash.
   */
-  mtx_lock(&gab.eg->strings_mtx);
-
-  struct gab_obj_string *interned =
-      gab_egstrfind(gab.eg, hash, len, buff->data);
-
-  if (interned)
-    return a_char_destroy(buff), mtx_unlock(&gab.eg->strings_mtx),
-           __gab_obj(interned);
-
-  gab_value result = nstring(gab, hash, len, buff->data);
+  gab_value result = intern(gab, hash, len, buff->data);
 
   assert(gab_valkind(result) == kGAB_STRING);
 
-  return a_char_destroy(buff), mtx_unlock(&gab.eg->strings_mtx), result;
+  return a_char_destroy(buff), result;
 };
 
 gab_value gab_prototype(struct gab_triple gab, struct gab_src *src,
@@ -1178,7 +1481,7 @@ gab_value gab_shpwithout(struct gab_triple gab, gab_value shape,
   for (uint64_t i = 0; i < len - 1; i++) {
     gab_value thiskey = gab_ushpat(shape, i);
 
-    if (key == thiskey) // This performs the swap
+    if (gab_valeq(key, thiskey)) // This performs the swap
       shp = gab_shpwith(gab, shp, last_key);
     else
       shp = gab_shpwith(gab, shp, thiskey);
@@ -1191,6 +1494,8 @@ gab_value gab_shpwithout(struct gab_triple gab, gab_value shape,
 }
 
 gab_value gab_shpwith(struct gab_triple gab, gab_value shp, gab_value key) {
+  key = gab_valintern(gab, key);
+
   mtx_lock(&gab.eg->shapes_mtx);
 
   assert(gab_valkind(shp) == kGAB_SHAPE || gab_valkind(shp) == kGAB_SHAPELIST);
@@ -1250,6 +1555,16 @@ gab_value gab_fiber(struct gab_triple gab, struct gab_fiber_argt args) {
   self->data[0] = args.message;
   self->data[1] = args.receiver;
 
+  // The receiver, arguments, var and return frame must fit in the first
+  // allocation. Anything beyond that is grown into by the vm.
+  self->vm.cap = cGAB_STACK_INITIAL;
+  if (self->vm.cap < args.argc + 8)
+    self->vm.cap = args.argc + 8;
+
+  self->vm.eg = gab.eg;
+  self->vm.sb = gab_egmalloc(
+      gab.eg, (self->vm.cap + cGAB_STACK_HEADROOM) * sizeof(gab_value));
+
   self->vm.fp = self->vm.sb + 3;
   self->vm.sp = self->vm.sb + 3;
 
@@ -1267,6 +1582,8 @@ gab_value gab_fiber(struct gab_triple gab, struct gab_fiber_argt args) {
 
   self->vm.ip = nullptr;
 
+  gab_wlcreate(&self->waiters);
+
   return __gab_obj(self);
 }
 
@@ -1276,27 +1593,146 @@ a_gab_value *gab_fibawait(struct gab_triple gab, gab_value f) {
 
   struct gab_obj_fiber *fiber = GAB_VAL_TO_FIBER(f);
 
-  while (fiber->header.kind != kGAB_FIBERDONE)
-    gab_yield(gab);
+  for (;;) {
+    uint64_t key = gab_wlkey(&fiber->waiters);
+
+    if (fiber->header.kind == kGAB_FIBERDONE)
+      break;
+
+    gab_wlwait(gab, &fiber->waiters, key, -1);
+  }
 
   return fiber->res;
 }
 
-gab_value gab_channel(struct gab_triple gab) {
-  struct gab_obj_channel *self = GAB_CREATE_OBJ(gab_obj_channel, kGAB_CHANNEL);
+gab_value gab_channel(struct gab_triple gab, uint64_t len) {
+  struct gab_obj_channel *self =
+      GAB_CREATE_FLEX_OBJ(gab_obj_channel, struct gab_chnslot, len, kGAB_CHANNEL);
 
   self->data = gab_undefined;
+  self->len = len;
+  self->head = 0;
+  self->tail = 0;
+
+  for (uint64_t i = 0; i < len; i++)
+    self->buffer[i].seq = i;
+
+  gab_wlcreate(&self->takers);
+  gab_wlcreate(&self->putters);
+
+  mtx_init(&self->mtx, mtx_plain);
+  self->nparked = 0;
+  memset(self->parked, 0, sizeof(self->parked));
 
   return __gab_obj(self);
 }
 
-void gab_chnclose(gab_value c) {
+static bool chn_isready(gab_value c, enum gab_chnwait k) {
+  if (gab_chnisclosed(c))
+    return true;
+
+  return k == kGAB_CHNWAIT_TAKE ? !gab_chnisempty(c) : !gab_chnisfull(c);
+}
+
+static gab_value chnparked_take(struct gab_chnparked *q) {
+  if (q->head == q->fibers.len)
+    return gab_undefined;
+
+  gab_value fiber = q->fibers.data[q->head++];
+
+  // Drop the front of the line once it is most of the vector, so that a
+  // line which never empties doesn't grow forever.
+  if (q->head * 2 >= q->fibers.len) {
+    q->fibers.len -= q->head;
+    memmove(q->fibers.data, q->fibers.data + q->head,
+            q->fibers.len * sizeof(gab_value));
+    q->head = 0;
+  }
+
+  return fiber;
+}
+
+/*
+ * Move the first fiber in line for k - or all of them - back onto a job's
+ * deque. Call this after changing the state the fibers are waiting on.
+ */
+static void chn_wake(struct gab_triple gab, struct gab_obj_channel *channel,
+                     enum gab_chnwait k, bool all) {
+  // Pairs with the fence in gab_chnpark. Either a parking fiber sees the
+  // change we just made, or we see it in line.
+  atomic_thread_fence(memory_order_seq_cst);
+
+  if (!channel->nparked)
+    return;
+
+  struct gab_chnparked *q = channel->parked + k;
+
+  mtx_lock(&channel->mtx);
+
+  if (!all) {
+    gab_value fiber = chnparked_take(q);
+
+    if (fiber != gab_undefined)
+      channel->nparked--;
+
+    mtx_unlock(&channel->mtx);
+
+    if (fiber != gab_undefined)
+      gab_fibresume(gab, fiber);
+
+    return;
+  }
+
+  // Take the whole line, so that it is resumed without holding the lock.
+  struct gab_chnparked woken = *q;
+  *q = (struct gab_chnparked){0};
+  channel->nparked -= woken.fibers.len - woken.head;
+
+  mtx_unlock(&channel->mtx);
+
+  for (uint64_t i = woken.head; i < woken.fibers.len; i++)
+    gab_fibresume(gab, woken.fibers.data[i]);
+
+  v_gab_value_destroy(&woken.fibers);
+}
+
+void gab_chnpark(struct gab_triple gab, gab_value f) {
+  struct gab_vm *vm = &GAB_VAL_TO_FIBER(f)->vm;
+
+  // Once the fiber is in line it may be resumed (and park again) at any
+  // moment, so hold on to where it parked.
+  gab_value c = vm->channel;
+  enum gab_chnwait k = vm->waiting;
+
+  struct gab_obj_channel *channel = GAB_VAL_TO_CHANNEL(c);
+
+  mtx_lock(&channel->mtx);
+  v_gab_value_push(&channel->parked[k].fibers, f);
+  channel->nparked++;
+  mtx_unlock(&channel->mtx);
+
+  atomic_thread_fence(memory_order_seq_cst);
+
+  // Whoever made the channel ready before we got in line didn't see us, so
+  // check again. Everyone waiting for a taker, or on a closed channel, can
+  // go - otherwise just one.
+  if (chn_isready(c, k))
+    chn_wake(gab, channel, k,
+             k == kGAB_CHNWAIT_TAKER || gab_chnisclosed(c));
+}
+
+void gab_chnclose(struct gab_triple gab, gab_value c) {
   assert(gab_valkind(c) >= kGAB_CHANNEL &&
          gab_valkind(c) <= kGAB_CHANNELCLOSED);
 
   struct gab_obj_channel *channel = GAB_VAL_TO_CHANNEL(c);
 
   channel->header.kind = kGAB_CHANNELCLOSED;
+  gab_wlnotify(&channel->takers);
+  gab_wlnotify(&channel->putters);
+
+  for (uint64_t k = 0; k < kGAB_CHNWAIT_NKINDS; k++)
+    chn_wake(gab, channel, k, true);
 }
 
 bool gab_chnisclosed(gab_value c) {
@@ -1312,6 +1748,9 @@ bool gab_chnisempty(gab_value c) {
 
   struct gab_obj_channel *channel = GAB_VAL_TO_CHANNEL(c);
 
+  if (channel->len)
+    return channel->tail <= channel->head;
+
   return channel->data == gab_undefined;
 };
 
@@ -1321,52 +1760,177 @@ bool gab_chnisfull(gab_value c) {
 
   struct gab_obj_channel *channel = GAB_VAL_TO_CHANNEL(c);
 
+  if (channel->len)
+    return channel->tail - channel->head >= channel->len;
+
   return channel->data != gab_undefined;
 };
 
-bool channel_put(struct gab_obj_channel *channel, gab_value value) {
-  static gab_value undef = gab_undefined;
-  return atomic_compare_exchange_weak(&channel->data, &undef, value);
+/*
+ * Claim the slot at tail, if it is free. Every slot is claimed by exactly
+ * one put per lap of the ring, so the write needs no further synchronization.
+ */
+static bool ring_put(struct gab_obj_channel *channel, gab_value value) {
+  uint64_t pos = atomic_load_explicit(&channel->tail, memory_order_relaxed);
+
+  for (;;) {
+    struct gab_chnslot *slot = channel->buffer + pos % channel->len;
+    uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    int64_t diff = (int64_t)seq - (int64_t)pos;
+
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&channel->tail, &pos, pos + 1,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed)) {
+        slot->value = value;
+        atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      // The take from the last lap hasn't freed this slot - we're full.
+      return false;
+    } else {
+      pos = atomic_load_explicit(&channel->tail, memory_order_relaxed);
+    }
+  }
 }
 
-gab_value channel_take(struct gab_obj_channel *channel) {
-  return atomic_exchange(&channel->data, gab_undefined);
+static gab_value ring_take(struct gab_obj_channel *channel) {
+  uint64_t pos = atomic_load_explicit(&channel->head, memory_order_relaxed);
+
+  for (;;) {
+    struct gab_chnslot *slot = channel->buffer + pos % channel->len;
+    uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    int64_t diff = (int64_t)seq - (int64_t)(pos + 1);
+
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&channel->head, &pos, pos + 1,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed)) {
+        gab_value value = slot->value;
+        atomic_store_explicit(&slot->seq, pos + channel->len,
+                              memory_order_release);
+        return value;
+      }
+    } else if (diff < 0) {
+      // The put for this slot hasn't happened (or finished) - we're empty.
+      return gab_undefined;
+    } else {
+      pos = atomic_load_explicit(&channel->head, memory_order_relaxed);
+    }
+  }
+}
+
+bool gab_chntryput(struct gab_triple gab, gab_value c, gab_value value) {
+  struct gab_obj_channel *channel = GAB_VAL_TO_CHANNEL(c);
+
+  if (channel->len) {
+    // Unlike the unbuffered slot, the buffer owns the values in it.
+    gab_iref(gab, value);
+
+    if (!ring_put(channel, value))
+      return gab_dref(gab, value), false;
+  } else {
+    gab_value undef = gab_undefined;
+
+    if (!atomic_compare_exchange_strong(&channel->data, &undef, value))
+      return false;
+  }
+
+  // There is one more value to take.
+  gab_wlnotifyone(&channel->takers);
+  chn_wake(gab, channel, kGAB_CHNWAIT_TAKE, false);
+  return true;
+}
+
+gab_value gab_chntrytake(struct gab_triple gab, gab_value c) {
+  struct gab_obj_channel *channel = GAB_VAL_TO_CHANNEL(c);
+
+  gab_value v = channel->len ? ring_take(channel)
+                             : atomic_exchange(&channel->data, gab_undefined);
+
+  if (v == gab_undefined)
+    return v;
+
+  if (channel->len)
+    gab_dref(gab, v);
+
+  // There is room for one more put. On an unbuffered channel, the put we
+  // took from is also done - but its waiter can't tell that its own value
+  // was taken, so every waiter for a taker checks again.
+  if (channel->len) {
+    gab_wlnotifyone(&channel->putters);
+  } else {
+    gab_wlnotify(&channel->putters);
+    chn_wake(gab, channel, kGAB_CHNWAIT_TAKER, true);
+  }
+
+  chn_wake(gab, channel, kGAB_CHNWAIT_PUT, false);
+  return v;
+}
+
+static uint64_t channel_deadline(size_t nms) {
+  if (nms == (size_t)-1)
+    return -1;
+
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+
+  return ts.tv_sec * 1000000000 + ts.tv_nsec + nms * 1000000;
+}
+
+/*
+ * Sleep on the channel's waitlist until it changes, or until the deadline.
+ * Returns false if the deadline has passed.
+ */
+static bool channel_wait(struct gab_triple gab, struct gab_waitlist *wl,
+                         uint64_t key, uint64_t deadline_ns) {
+  if (deadline_ns == (uint64_t)-1)
+    return gab_wlwait(gab, wl, key, -1), true;
+
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+
+  uint64_t now_ns = ts.tv_sec * 1000000000 + ts.tv_nsec;
+  if (now_ns >= deadline_ns)
+    return false;
+
+  gab_wlwait(gab, wl, key, deadline_ns - now_ns);
+  return true;
 }
 
 bool channel_block_while_full(struct gab_triple gab,
                               struct gab_obj_channel *channel, gab_value c,
-                              uint64_t timeout_ns, uint64_t *timer_ns) {
-  while (gab_chnisfull(c)) {
-    gab_yield(gab);
+                              uint64_t deadline_ns) {
+  for (;;) {
+    uint64_t key = gab_wlkey(&channel->putters);
 
-    *timer_ns += GAB_YIELD_SLEEPTIME_NS;
+    if (!gab_chnisfull(c))
+      return true;
 
     if (gab_chnisclosed(c))
       return false;
 
-    if (*timer_ns > timeout_ns)
+    if (!channel_wait(gab, &channel->putters, key, deadline_ns))
       return false;
   }
-
-  return true;
 }
 
 bool channel_block_while_empty(struct gab_triple gab,
                                struct gab_obj_channel *channel, gab_value c,
-                               uint64_t timeout_ns, uint64_t *timer_ns) {
-  while (gab_chnisempty(c)) {
-    gab_yield(gab);
+                               uint64_t deadline_ns) {
+  for (;;) {
+    uint64_t key = gab_wlkey(&channel->takers);
 
-    *timer_ns += GAB_YIELD_SLEEPTIME_NS;
+    if (!gab_chnisempty(c))
+      return true;
 
     if (gab_chnisclosed(c))
       return false;
 
-    if (*timer_ns > timeout_ns)
+    if (!channel_wait(gab, &channel->takers, key, deadline_ns))
       return false;
   }
-
-  return true;
 }
 
 gab_value channel_blocking_put(struct gab_triple gab,
@@ -1374,21 +1938,24 @@ gab_value channel_blocking_put(struct gab_triple gab,
                                gab_value v, size_t nms) {
   gab_value res = gab_undefined;
 
-  const uint64_t timeout_ns = nms * 1000000;
-  uint64_t timer_ns = 0;
+  const uint64_t deadline_ns = channel_deadline(nms);
 
   while (true) {
-    if (!channel_block_while_full(gab, channel, c, timeout_ns, &timer_ns))
+    if (!channel_block_while_full(gab, channel, c, deadline_ns))
       return gab_undefined;
 
-    if (channel_put(channel, v))
+    if (gab_chntryput(gab, c, v))
       break;
   }
 
+  // A buffered put is done once the value is in the buffer.
+  if (channel->len)
+    return res;
+
   // If a taker never arrives, we should remove our value as if our put
   // failed.
-  if (!channel_block_while_full(gab, channel, c, timeout_ns, &timer_ns))
-    return channel_take(channel), false;
+  if (!channel_block_while_full(gab, channel, c, deadline_ns))
+    return gab_chntrytake(gab, c), false;
 
   return res;
 }
@@ -1398,14 +1965,13 @@ gab_value channel_blocking_take(struct gab_triple gab,
                                 size_t nms) {
   gab_value res = gab_undefined;
 
-  const uint64_t timeout_ns = nms * 1000000;
-  uint64_t timer_ns = 0;
+  const uint64_t deadline_ns = channel_deadline(nms);
 
   while (res == gab_undefined) {
-    if (!channel_block_while_empty(gab, channel, c, timeout_ns, &timer_ns))
+    if (!channel_block_while_empty(gab, channel, c, deadline_ns))
       return gab_undefined;
 
-    res = channel_take(channel);
+    res = gab_chntrytake(gab, c);
   }
 
   return res;
@@ -1445,10 +2011,7 @@ gab_value gab_tchntake(struct gab_triple gab, gab_value c, uint64_t nms) {
   case kGAB_CHANNEL:
     return channel_blocking_take(gab, channel, c, nms);
   case kGAB_CHANNELCLOSED:
-    if (gab_chnisempty(c))
-      return gab_undefined;
-    else
-      return channel_take(channel);
+    return gab_chntrytake(gab, c);
   default:
     break;
   }
@@ -1625,17 +2188,21 @@ static uint64_t dumpInstruction(FILE *stream, struct gab_obj_prototype *self,
   case OP_LOCALTAILSEND_BLOCK:
   case OP_MATCHSEND_BLOCK:
   case OP_MATCHTAILSEND_BLOCK:
+  case OP_SEND_POLYMORPHIC:
+  case OP_SEND_MEGAMORPHIC:
     return dumpSendInstruction(stream, self, offset);
   case OP_POP_N:
   case OP_STORE_LOCAL:
   case OP_POPSTORE_LOCAL:
   case OP_LOAD_UPVALUE:
   case OP_LOAD_LOCAL:
+  case OP_LOAD_LOCAL_CONSTANT_SEND_NUMERIC:
     return dumpByteInstruction(stream, self, offset);
   case OP_NPOPSTORE_STORE_LOCAL:
   case OP_NPOPSTORE_LOCAL:
   case OP_NLOAD_UPVALUE:
-  case OP_NLOAD_LOCAL: {
+  case OP_NLOAD_LOCAL:
+  case OP_NLOAD_LOCAL_SEND_NUMERIC: {
     const char *name =
         gab_opcode_names[v_uint8_t_val_at(&self->src->bytecode, offset)];
 
@@ -1735,5 +2302,133 @@ int gab_fmodinspect(FILE *stream, struct gab_obj_prototype *proto) {
   return 0;
 }
 
+/*
+ * A module can only be written out if each of its constants can be recreated
+ * from bytes, and its main block doesn't capture anything.
+ */
+static bool src_iswritable(struct gab_obj_prototype *mainp) {
+  struct gab_src *src = mainp->src;
+
+  if (mainp->nupvalues)
+    return false;
+
+  for (uint64_t k = 0; k < src->constants.len; k++) {
+    gab_value v = src->constants.data[k];
+
+    switch (gab_valiso(v) ? gab_valkind(v) : kGAB_NUMBER) {
+    case kGAB_PROTOTYPE:
+      if (GAB_VAL_TO_PROTOTYPE(v)->src != src)
+        return false;
+      break;
+    case kGAB_NUMBER:
+    case kGAB_STRING:
+    case kGAB_BINARY:
+    case kGAB_SIGIL:
+    case kGAB_MESSAGE:
+      break;
+    default:
+      return false;
+    }
+  }
+
+  return true;
+}
+
+#define GBOF_WRITE(stream, v) fwrite(&(v), sizeof(v), 1, (stream))
+
+static void gbof_writeprototype(FILE *stream, uint16_t k,
+                                struct gab_obj_prototype *p) {
+  GBOF_WRITE(stream, k);
+  GBOF_WRITE(stream, p->offset);
+  GBOF_WRITE(stream, p->len);
+  GBOF_WRITE(stream, p->narguments);
+  GBOF_WRITE(stream, p->nslots);
+  GBOF_WRITE(stream, p->nlocals);
+  GBOF_WRITE(stream, p->nupvalues);
+  fwrite(p->data, sizeof(uint8_t), p->nupvalues, stream);
+}
+
+/*
+ * The layout is:
+ *  magic, version, number of opcodes, source length and hash
+ *  bytecode length, bytecode, bytecode tokens
+ *  number of constants, then each constant as a kind followed by its data
+ *  number of prototypes, then each prototype (main is last)
+ *
+ * Values are written in the host's byte order - a gbof is a cache, not a
+ * distribution format.
+ */
+int gab_fwritegbof(FILE *stream, gab_value main) {
+  assert(gab_valkind(main) == kGAB_BLOCK);
+
+  struct gab_obj_prototype *mainp =
+      GAB_VAL_TO_PROTOTYPE(GAB_VAL_TO_BLOCK(main)->p);
+
+  struct gab_src *src = mainp->src;
+
+  if (!src_iswritable(mainp))
+    return -1;
+
+  uint32_t version = GAB_GBOF_VERSION;
+  uint32_t nops = LEN_CARRAY(gab_opcode_names);
+  uint64_t srclen = src->source->len;
+  uint64_t srchash = FNV1a_64((uint8_t *)src->source->data, srclen);
+
+  fwrite(GAB_GBOF_MAGIC, 1, 4, stream);
+  GBOF_WRITE(stream, version);
+  GBOF_WRITE(stream, nops);
+  GBOF_WRITE(stream, srclen);
+  GBOF_WRITE(stream, srchash);
+
+  GBOF_WRITE(stream, src->bytecode.len);
+  fwrite(src->bytecode.data, sizeof(uint8_t), src->bytecode.len, stream);
+  fwrite(src->bytecode_toks.data, sizeof(uint64_t), src->bytecode_toks.len,
+         stream);
+
+  uint64_t nprototypes = 1;
+
+  GBOF_WRITE(stream, src->constants.len);
+  for (uint64_t k = 0; k < src->constants.len; k++) {
+    gab_value v = src->constants.data[k];
+
+    // Values which aren't objects are written as-is.
+    uint8_t kind = gab_valiso(v) ? gab_valkind(v) : kGAB_NKINDS;
+    GBOF_WRITE(stream, kind);
+
+    switch (kind) {
+    case kGAB_NKINDS:
+      GBOF_WRITE(stream, v);
+      break;
+    case kGAB_PROTOTYPE:
+      nprototypes++;
+      break;
+    default: {
+      gab_value str = kind == kGAB_BINARY    ? gab_bintostr(v)
+                      : kind == kGAB_SIGIL   ? gab_sigtostr(v)
+                      : kind == kGAB_MESSAGE ? gab_msgtostr(v)
+                                             : v;
+      uint64_t len = gab_strlen(str);
+      GBOF_WRITE(stream, len);
+      fwrite(gab_strdata(&str), sizeof(char), len, stream);
+      break;
+    }
+    }
+  }
+
+  GBOF_WRITE(stream, nprototypes);
+  for (uint64_t k = 0; k < src->constants.len; k++) {
+    gab_value v = src->constants.data[k];
+
+    if (gab_valkind(v) == kGAB_PROTOTYPE)
+      gbof_writeprototype(stream, k, GAB_VAL_TO_PROTOTYPE(v));
+  }
+
+  gbof_writeprototype(stream, 0, mainp);
+
+  return ferror(stream) ? -1 : 0;
+}
+
+#undef GBOF_WRITE
+
 #undef CREATE_GAB_FLEX_OBJ
 #undef CREATE_GAB_OBJ
@@ -117,7 +117,7 @@ struct bc {
   struct gab_src *src;
 
   uint8_t prev_op, pprev_op;
-  size_t prev_op_at;
+  size_t prev_op_at, pprev_op_at;
 };
 
 enum prec_k { kNONE, kEXP, kBINARY_SEND, kSEND, kSPECIAL_SEND, kPRIMARY };
@@ -156,7 +156,7 @@ static s_char prev_src(struct parser *parser) {
 static gab_value prev_id(struct gab_triple gab, struct parser *parser) {
   s_char s = prev_src(parser);
 
-  return gab_nstring(gab, s.len, s.data);
+  return gab_ninterned(gab, s.len, s.data);
 }
 
 static gab_value tok_id(struct gab_triple gab, gab_token tok) {
@@ -295,7 +295,7 @@ static gab_value trim_prev_id(struct gab_triple gab, struct parser *parser) {
   s.len--;
 
   // These can cause collections during compilation.
-  return gab_nstring(gab, s.len, s.data);
+  return gab_ninterned(gab, s.len, s.data);
 }
 
 static inline bool match_token(struct parser *parser, gab_token tok) {
@@ -914,6 +914,7 @@ static int bc_error(struct gab_triple gab, struct bc *bc, gab_value node,
 
 static inline void push_op(struct bc *bc, uint8_t op, gab_value node) {
   bc->pprev_op = bc->prev_op;
+  bc->pprev_op_at = bc->prev_op_at;
   bc->prev_op = op;
 
   assert(d_uint64_t_exists(&bc->src->node_begin_toks, node));
@@ -1141,22 +1142,43 @@ static inline uint8_t encode_arity(struct gab_triple gab, gab_value lhs,
 static inline void push_send(struct gab_triple gab, struct bc *bc, gab_value m,
                              gab_value lhs, gab_value rhs, gab_value node) {
   if (gab_valkind(m) == kGAB_STRING)
-    m = gab_strtomsg(m);
+    m = gab_strtomsg(gab_valintern(gab, m));
 
   assert(gab_valkind(m) == kGAB_MESSAGE);
 
   uint16_t ks = addk(gab, bc, m);
-  addk(gab, bc, gab_undefined);
 
-  for (int i = 0; i < cGAB_SEND_CACHE_LEN; i++) {
-    for (int j = 0; j < GAB_SEND_CACHE_SIZE; j++) {
-      addk(gab, bc, gab_undefined);
+  for (int i = 1; i < GAB_SEND_NKS; i++)
+    addk(gab, bc, gab_undefined);
+
+  uint8_t have = encode_arity(gab, lhs, rhs);
+
+#if cGAB_SUPERINSTRUCTIONS
+  /*
+   * Fuse loads which feed straight into a binary send with it. The fused
+   * instruction only replaces the load's opcode - once the send has been
+   * specialized for numbers it does the whole thing, and otherwise it does
+   * the load and falls through to the instructions after it.
+   */
+  if (have == (2 << 2)) {
+    switch (bc->prev_op) {
+    case OP_CONSTANT:
+      if (bc->pprev_op == OP_LOAD_LOCAL &&
+          bc->pprev_op_at + 2 == bc->prev_op_at)
+        v_uint8_t_set(&bc->bc, bc->pprev_op_at,
+                      OP_LOAD_LOCAL_CONSTANT_SEND_NUMERIC);
+      break;
+    case OP_NLOAD_LOCAL:
+      if (v_uint8_t_val_at(&bc->bc, bc->prev_op_at + 1) == 2)
+        v_uint8_t_set(&bc->bc, bc->prev_op_at, OP_NLOAD_LOCAL_SEND_NUMERIC);
+      break;
     }
   }
+#endif
 
   push_op(bc, OP_SEND, node);
   push_short(bc, ks, node);
-  push_byte(bc, encode_arity(gab, lhs, rhs), node);
+  push_byte(bc, have, node);
 }
 
 static inline void push_pop(struct bc *bc, uint8_t n, gab_value node) {
@@ -1994,3 +2016,233 @@ gab_value gab_build(struct gab_triple gab, struct gab_build_argt args) {
 
   return gab_gcunlock(gab), main;
 }
+
+gab_value gab_load(struct gab_triple gab, struct gab_load_argt args) {
+  gab.flags = args.flags;
+
+  args.name = args.name ? args.name : "__main__";
+
+  gab_gclock(gab);
+
+  gab_value mod = gab_string(gab, args.name);
+
+  struct gab_src *src =
+      gab_src(gab, mod, args.source, strlen(args.source) + 1);
+
+  // This module has already been loaded (or built) - bail.
+  if (src->bytecode.len)
+    return gab_gcunlock(gab), gab_undefined;
+
+  gab_srcappend(src, args.len, (uint8_t *)args.bytecode,
+                (uint64_t *)args.bytecode_toks);
+
+  // Lexing the source pushed the common immediates. They are already in the
+  // module's constants, so start over.
+  src->constants.len = 0;
+
+  v_gab_value_cap(&src->constants, args.nconstants);
+  memcpy(src->constants.data, args.constants,
+         args.nconstants * sizeof(gab_value));
+  src->constants.len = args.nconstants;
+
+  gab_niref(gab, 1, args.nconstants, src->constants.data);
+  gab_negkeep(gab.eg, args.nconstants, src->constants.data);
+
+  assert(args.nprototypes > 0);
+
+  gab_value proto = gab_undefined;
+
+  for (uint64_t i = 0; i < args.nprototypes; i++) {
+    const struct gab_load_prototype *p = args.prototypes + i;
+
+    proto = gab_prototype(gab, src, p->offset, p->len,
+                          (struct gab_prototype_argt){
+                              .narguments = p->narguments,
+                              .nslots = p->nslots,
+                              .nlocals = p->nlocals,
+                              .nupvalues = p->nupvalues,
+                              .data = (char *)p->data,
+                          });
+
+    gab_iref(gab, proto);
+    gab_egkeep(gab.eg, proto);
+
+    // The main prototype is last, and isn't held by any constant.
+    if (i + 1 < args.nprototypes) {
+      assert(p->k < src->constants.len);
+      src->constants.data[p->k] = proto;
+    }
+  }
+
+  gab_srccomplete(gab, src);
+
+  gab_value main = gab_block(gab, proto);
+
+  gab_iref(gab, main);
+  gab_egkeep(gab.eg, main);
+
+  return gab_gcunlock(gab), main;
+}
+
+struct gbof {
+  const uint8_t *data;
+  uint64_t len, cursor;
+};
+
+static bool gbof_read(struct gbof *self, uint64_t n, void *dst) {
+  if (self->len - self->cursor < n)
+    return false;
+
+  memcpy(dst, self->data + self->cursor, n);
+  self->cursor += n;
+  return true;
+}
+
+static const void *gbof_take(struct gbof *self, uint64_t n) {
+  if (self->len - self->cursor < n)
+    return nullptr;
+
+  const void *data = self->data + self->cursor;
+  self->cursor += n;
+  return data;
+}
+
+#define GBOF_READ(self, v) gbof_read((self), sizeof(v), &(v))
+
+gab_value gab_loadgbof(struct gab_triple gab, const char *name,
+                       const char *source, uint64_t len, const uint8_t *data) {
+  struct gbof r = {.data = data, .len = len};
+
+  char magic[4];
+  uint32_t version, nops;
+  uint64_t srclen, srchash, bclen;
+
+  if (!GBOF_READ(&r, magic) || memcmp(magic, GAB_GBOF_MAGIC, 4))
+    return gab_undefined;
+
+  if (!GBOF_READ(&r, version) || version != GAB_GBOF_VERSION)
+    return gab_undefined;
+
+  if (!GBOF_READ(&r, nops) || nops != LEN_CARRAY(gab_opcode_names))
+    return gab_undefined;
+
+  // The source includes its null terminator, like in gab_build.
+  if (!GBOF_READ(&r, srclen) || srclen != strlen(source) + 1)
+    return gab_undefined;
+
+  if (!GBOF_READ(&r, srchash) ||
+      srchash != FNV1a_64((const uint8_t *)source, srclen))
+    return gab_undefined;
+
+  if (!GBOF_READ(&r, bclen))
+    return gab_undefined;
+
+  const uint8_t *bc = gbof_take(&r, bclen);
+
+  if (bc == nullptr || bclen > r.len / sizeof(uint64_t))
+    return gab_undefined;
+
+  uint64_t *toks = malloc(bclen * sizeof(uint64_t));
+  gab_value *ks = nullptr;
+  struct gab_load_prototype *protos = nullptr;
+  gab_value main = gab_undefined;
+
+  if (!gbof_read(&r, bclen * sizeof(uint64_t), toks))
+    goto fin;
+
+  uint64_t nks;
+  if (!GBOF_READ(&r, nks) || nks > r.len)
+    goto fin;
+
+  ks = malloc(nks * sizeof(gab_value));
+
+  gab_gclock(gab);
+
+  for (uint64_t k = 0; k < nks; k++) {
+    uint8_t kind;
+    if (!GBOF_READ(&r, kind))
+      goto fin_locked;
+
+    switch (kind) {
+    case kGAB_NKINDS:
+      if (!GBOF_READ(&r, ks[k]))
+        goto fin_locked;
+      break;
+    case kGAB_PROTOTYPE:
+      ks[k] = gab_undefined;
+      break;
+    case kGAB_STRING:
+    case kGAB_BINARY:
+    case kGAB_SIGIL:
+    case kGAB_MESSAGE: {
+      uint64_t len;
+      if (!GBOF_READ(&r, len))
+        goto fin_locked;
+
+      const char *str = gbof_take(&r, len);
+      if (str == nullptr)
+        goto fin_locked;
+
+      gab_value v = kind == kGAB_SIGIL || kind == kGAB_MESSAGE
+                        ? gab_ninterned(gab, len, str)
+                        : gab_nstring(gab, len, str);
+
+      ks[k] = kind == kGAB_BINARY    ? gab_strtobin(v)
+              : kind == kGAB_SIGIL   ? gab_strtosig(v)
+              : kind == kGAB_MESSAGE ? gab_strtomsg(v)
+                                     : v;
+      break;
+    }
+    default:
+      goto fin_locked;
+    }
+  }
+
+  uint64_t nprotos;
+  if (!GBOF_READ(&r, nprotos) || nprotos == 0 || nprotos > r.len)
+    goto fin_locked;
+
+  protos = malloc(nprotos * sizeof(struct gab_load_prototype));
+
+  for (uint64_t i = 0; i < nprotos; i++) {
+    struct gab_load_prototype *p = protos + i;
+
+    if (!GBOF_READ(&r, p->k) || !GBOF_READ(&r, p->offset) ||
+        !GBOF_READ(&r, p->len) || !GBOF_READ(&r, p->narguments) ||
+        !GBOF_READ(&r, p->nslots) || !GBOF_READ(&r, p->nlocals) ||
+        !GBOF_READ(&r, p->nupvalues))
+      goto fin_locked;
+
+    p->data = gbof_take(&r, p->nupvalues);
+
+    if (p->data == nullptr || p->offset > bclen || p->len > bclen - p->offset)
+      goto fin_locked;
+
+    if (i + 1 < nprotos && (p->k >= nks || ks[p->k] != gab_undefined))
+      goto fin_locked;
+  }
+
+  main = gab_load(gab, (struct gab_load_argt){
+                           .name = name,
+                           .source = source,
+                           .flags = gab.flags,
+                           .len = bclen,
+                           .bytecode = bc,
+                           .bytecode_toks = toks,
+                           .nconstants = nks,
+                           .constants = ks,
+                           .nprototypes = nprotos,
+                           .prototypes = protos,
+                       });
+
+fin_locked:
+  gab_gcunlock(gab);
+
+fin:
+  free(toks);
+  free(ks);
+  free(protos);
+  return main;
+}
+
+#undef GBOF_READ
@@ -50,7 +50,7 @@ static handler handlers[] = {
       STORE_SP();                                                              \
       gab_gcepochnext(GAB());                                                  \
     }                                                                          \
-    assert(SP() < VM()->sb + cGAB_STACK_MAX);                                  \
+    assert(SP() < VM()->sb + VM()->cap + cGAB_STACK_HEADROOM);                 \
     assert(SP() > FB());                                                       \
                                                                                \
     [[clang::musttail]] return handlers[o](DISPATCH_ARGS());                   \
@@ -178,6 +178,21 @@ static handler handlers[] = {
     NEXT();                                                                    \
   }
 
+#define BINARY_NUMERIC_SENDS(IMPL)                                             \
+  IMPL(PRIMITIVE_ADD, gab_number, double, +)                                   \
+  IMPL(PRIMITIVE_SUB, gab_number, double, -)                                   \
+  IMPL(PRIMITIVE_MUL, gab_number, double, *)                                   \
+  IMPL(PRIMITIVE_DIV, gab_number, double, /)                                   \
+  IMPL(PRIMITIVE_MOD, gab_number, uint64_t, %)                                 \
+  IMPL(PRIMITIVE_BOR, gab_number, uint64_t, |)                                 \
+  IMPL(PRIMITIVE_BND, gab_number, uint64_t, &)                                 \
+  IMPL(PRIMITIVE_LSH, gab_number, uint64_t, <<)                                \
+  IMPL(PRIMITIVE_RSH, gab_number, uint64_t, >>)                                \
+  IMPL(PRIMITIVE_LT, gab_bool, double, <)                                      \
+  IMPL(PRIMITIVE_LTE, gab_bool, double, <=)                                    \
+  IMPL(PRIMITIVE_GT, gab_bool, double, >)                                      \
+  IMPL(PRIMITIVE_GTE, gab_bool, double, >=)
+
 // FIXME: This doesn't work
 // These boolean sends don't work because there is no longer a boolean type.
 // There are just sigils
@@ -546,20 +561,91 @@ static inline uint64_t compute_arity(uint64_t var, uint8_t have) {
   return var * (have & fHAVE_VAR) + (have >> 2);
 }
 
-static inline bool has_callspace(gab_value *sp, gab_value *sb,
+static inline bool has_callspace(struct gab_vm *vm, gab_value *sp,
                                  uint64_t space_needed) {
-  if ((sp - sb) + space_needed + 3 >= cGAB_STACK_MAX) {
+  if ((sp - vm->sb) + space_needed + 3 >= vm->cap) {
+    return false;
+  }
+
+  return true;
+}
+
+/*
+ * Grow the stack of vm so that space_needed more values fit above vm->sp.
+ *
+ * The stack is reallocated, so vm->sp, vm->fp and the parent pointers saved
+ * in every frame are rebased onto the new allocation. Callers must reload
+ * any stack pointers they are holding.
+ *
+ * cGAB_STACK_HEADROOM slots are allocated past the capacity, for the
+ * temporaries a frame pushes beyond its nslots.
+ */
+static bool grow_callspace(struct gab_vm *vm, uint64_t space_needed) {
+  uint64_t len = vm->sp - vm->sb;
+
+  if (len + space_needed + 3 >= cGAB_STACK_MAX)
     return false;
+
+  uint64_t cap = vm->cap;
+  while (len + space_needed + 3 >= cap)
+    cap *= 2;
+
+  if (cap > cGAB_STACK_MAX)
+    cap = cGAB_STACK_MAX;
+
+  uintptr_t old = (uintptr_t)vm->sb;
+  gab_value *sb = gab_egrealloc(vm->eg, vm->sb,
+                                (cap + cGAB_STACK_HEADROOM) * sizeof(gab_value));
+
+  if (sb == nullptr)
+    return false;
+
+  // Frames point at their parent's frame base with a raw pointer.
+  // Walk the chain and rebase each of them.
+  gab_value *f = sb + ((uintptr_t)vm->fp - old) / sizeof(gab_value);
+  vm->fp = f;
+  vm->sp = sb + len;
+
+  while (f[-1]) {
+    gab_value *parent = sb + (f[-1] - old) / sizeof(gab_value);
+    f[-1] = (uintptr_t)parent;
+    f = parent;
   }
 
+  vm->sb = sb;
+  vm->cap = cap;
   return true;
 }
 
+/*
+ * Make sure n values fit above SP(), growing the stack if necessary.
+ *
+ * This reloads SP() and FB(), so any other pointers into the stack must be
+ * recomputed after it.
+ */
+#define ENSURE_CALLSPACE(n)                                                    \
+  ({                                                                           \
+    if (__gab_unlikely(!has_callspace(VM(), SP(), (n)))) {                     \
+      STORE_SP();                                                              \
+      STORE_FP();                                                              \
+                                                                               \
+      if (!grow_callspace(VM(), (n)))                                          \
+        ERROR(GAB_OVERFLOW, "");                                               \
+                                                                               \
+      SP() = VM()->sp;                                                         \
+      FB() = VM()->fp;                                                         \
+    }                                                                          \
+  })
+
+/*
+ * Natives push their results here, and CALL_NATIVE reserves GAB_RET_MAX
+ * slots for them before the call. The stack is never grown here: the
+ * native's argv points into it, and would be left dangling.
+ */
 inline uint64_t gab_nvmpush(struct gab_vm *vm, uint64_t argc,
                             gab_value argv[argc]) {
-  if (__gab_unlikely(argc == 0 || !has_callspace(vm->sp, vm->sb, argc))) {
+  if (__gab_unlikely(argc == 0 || !has_callspace(vm, vm->sp, argc)))
     return 0;
-  }
 
   for (uint8_t n = 0; n < argc; n++) {
     *vm->sp++ = argv[n];
@@ -580,8 +666,7 @@ inline uint64_t gab_nvmpush(struct gab_vm *vm, uint64_t argc,
   ({                                                                           \
     struct gab_obj_prototype *p = GAB_VAL_TO_PROTOTYPE(blk->p);                \
                                                                                \
-    if (__gab_unlikely(!has_callspace(SP(), SB(), p->nslots - have)))          \
-      ERROR(GAB_OVERFLOW, "");                                                 \
+    ENSURE_CALLSPACE(p->nslots - have);                                        \
                                                                                \
     PUSH_FRAME(blk, have);                                                     \
                                                                                \
@@ -598,8 +683,7 @@ inline uint64_t gab_nvmpush(struct gab_vm *vm, uint64_t argc,
   ({                                                                           \
     struct gab_obj_prototype *p = GAB_VAL_TO_PROTOTYPE(blk->p);                \
                                                                                \
-    if (__gab_unlikely(!has_callspace(SP(), SB(), 3 + p->nslots - have)))      \
-      ERROR(GAB_OVERFLOW, "");                                                 \
+    ENSURE_CALLSPACE(3 + p->nslots - have);                                    \
                                                                                \
     PUSH_FRAME(blk, have);                                                     \
                                                                                \
@@ -621,6 +705,8 @@ inline uint64_t gab_nvmpush(struct gab_vm *vm, uint64_t argc,
                                                                                \
     struct gab_obj_prototype *p = GAB_VAL_TO_PROTOTYPE(blk->p);                \
                                                                                \
+    ENSURE_CALLSPACE(p->nslots - have);                                        \
+                                                                               \
     IP() = proto_ip(GAB(), p);                                                 \
     KB() = proto_ks(GAB(), p);                                                 \
                                                                                \
@@ -638,6 +724,10 @@ inline uint64_t gab_nvmpush(struct gab_vm *vm, uint64_t argc,
     memmove(to, from, have * sizeof(gab_value));                               \
     SP() = to + have;                                                          \
                                                                                \
+    struct gab_obj_prototype *p = GAB_VAL_TO_PROTOTYPE(blk->p);                \
+                                                                               \
+    ENSURE_CALLSPACE(p->nslots - have);                                        \
+                                                                               \
     IP() = ((void *)ks[GAB_SEND_KOFFSET]);                                     \
                                                                                \
     SET_BLOCK(blk);                                                            \
@@ -670,11 +760,13 @@ inline uint64_t gab_nvmpush(struct gab_vm *vm, uint64_t argc,
 
 #define CALL_NATIVE(native, have, message)                                     \
   ({                                                                           \
+    ENSURE_CALLSPACE(GAB_RET_MAX);                                             \
+                                                                               \
     STORE();                                                                   \
                                                                                \
-    gab_value *to = SP() - have;                                               \
+    uint64_t to = SP() - SB() - have;                                          \
                                                                                \
-    gab_value *before = SP();                                                  \
+    uint64_t before = SP() - SB();                                             \
                                                                                \
     uint64_t pass = message ? have : have - 1;                                 \
                                                                                \
@@ -683,16 +775,17 @@ inline uint64_t gab_nvmpush(struct gab_vm *vm, uint64_t argc,
     if (__gab_unlikely(res))                                                   \
       return res;                                                              \
                                                                                \
+    /* The stack doesn't move during the call, but the native pushed */        \
     SP() = VM()->sp;                                                           \
                                                                                \
-    assert(SP() >= before);                                                    \
-    uint64_t have = SP() - before;                                             \
+    assert(SP() >= SB() + before);                                             \
+    uint64_t have = SP() - SB() - before;                                      \
                                                                                \
     if (!have)                                                                 \
       PUSH(gab_nil), have++;                                                   \
                                                                                \
-    memmove(to, before, have * sizeof(gab_value));                             \
-    SP() = to + have;                                                          \
+    memmove(SB() + to, SB() + before, have * sizeof(gab_value));               \
+    SP() = SB() + to + have;                                                   \
                                                                                \
     SET_VAR(have);                                                             \
                                                                                \
@@ -762,10 +855,13 @@ a_gab_value *do_vmexecfiber(struct gab_triple gab, gab_value f,
     struct gab_vm *vm = &fiber->vm;
     uint8_t op = gab_valtop(res.as.spec);
 
-    uint8_t ip[] = {0, 0, 3, OP_RETURN, 1};
-    gab_value ks[] = {
-        message, fiber->messages, gab_valtype(gab, receiver), res.as.spec, 0, 0,
-        0,
+    // Leave room for the whole send site, as a cache miss may rewrite it.
+    uint8_t ip[] = {OP_SEND, 0, 0, 3, OP_RETURN, 1};
+    gab_value ks[GAB_SEND_NKS] = {
+        message,
+        fiber->messages,
+        gab_valtype(gab, receiver),
+        res.as.spec,
     };
 
     // BLOCK IS NULL, SO THIS FAKE FRAME HAS NOTHING TO RETURN TO
@@ -777,25 +873,22 @@ a_gab_value *do_vmexecfiber(struct gab_triple gab, gab_value f,
     fiber->header.kind = kGAB_FIBERRUNNING;
 
     assert((*vm->sp) > 0);
-    return handlers[op](gab, ip, ks, vm->fp, vm->sp);
+    return handlers[op](gab, ip + 1, ks, vm->fp, vm->sp);
   }
   case kGAB_NATIVE: {
     struct gab_vm *vm = &fiber->vm;
 
-    uint8_t ip[] = {0, 0, 1, OP_RETURN, 1};
-    gab_value ks[] = {
+    uint8_t ip[] = {OP_SEND_NATIVE, 0, 0, 1, OP_RETURN, 1};
+    gab_value ks[GAB_SEND_NKS] = {
         message,
         fiber->messages,
         gab_valtype(gab, receiver),
         (uintptr_t)GAB_VAL_TO_NATIVE(res.as.spec),
-        0,
-        0,
-        0,
     };
 
     assert(fiber->header.kind != kGAB_FIBERDONE);
     fiber->header.kind = kGAB_FIBERRUNNING;
-    return OP_SEND_NATIVE_HANDLER(gab, ip, ks, vm->fp, vm->sp);
+    return OP_SEND_NATIVE_HANDLER(gab, ip + 1, ks, vm->fp, vm->sp);
   }
   case kGAB_BLOCK: {
     struct gab_vm *vm = &fiber->vm;
@@ -803,13 +896,24 @@ a_gab_value *do_vmexecfiber(struct gab_triple gab, gab_value f,
     struct gab_obj_block *b = GAB_VAL_TO_BLOCK(res.as.spec);
     struct gab_obj_prototype *p = GAB_VAL_TO_PROTOTYPE(b->p);
 
+    // A fresh stack is always far from cGAB_STACK_MAX, so this can only fail
+    // if the allocation does.
+    if (!has_callspace(vm, vm->sp, p->nslots)) {
+      [[maybe_unused]] bool grown = grow_callspace(vm, p->nslots);
+      assert(grown);
+    }
+
+    // The bottom frame runs the block, so that its code can be found from
+    // the stack like any other frame's.
+    vm->fp[-3] = (uintptr_t)b;
+
     vm->ip = proto_ip(gab, p);
     uint8_t *ip = vm->ip;
     uint8_t op = *ip++;
 
     assert(fiber->header.kind != kGAB_FIBERDONE);
     fiber->header.kind = kGAB_FIBERRUNNING;
-    return handlers[op](gab, ip, p->src->constants.data, vm->fp, vm->sp);
+    return handlers[op](gab, ip, proto_ks(gab, p), vm->fp, vm->sp);
   }
   default: {
     a_gab_value *results =
@@ -825,10 +929,54 @@ a_gab_value *do_vmexecfiber(struct gab_triple gab, gab_value f,
   }
 };
 
+static inline uint8_t *ip_move(struct gab_triple gab, uint64_t from,
+                               struct gab_obj_block *b, uint8_t *ip) {
+  struct gab_src *src = GAB_VAL_TO_PROTOTYPE(b->p)->src;
+  return src->thread_bytecode[gab.wkid - 1].bytecode +
+         (ip - src->thread_bytecode[from - 1].bytecode);
+}
+
+/*
+ * Move a parked fiber over to this job's copy of the bytecode. Each frame's
+ * ip is in its own block's code - the top one in vm->ip, and the others in
+ * the return address of the frame above them.
+ */
+static void vm_move(struct gab_triple gab, struct gab_vm *vm) {
+  gab_value *f = vm->fp;
+  struct gab_src *src = GAB_VAL_TO_PROTOTYPE(frame_block(f)->p)->src;
+
+  assert(vm->kb == src->thread_bytecode[vm->wkid - 1].constants);
+  vm->kb = src->thread_bytecode[gab.wkid - 1].constants;
+
+  vm->ip = ip_move(gab, vm->wkid, frame_block(f), vm->ip);
+
+  while (frame_parent(f) > vm->sb) {
+    gab_value *parent = frame_parent(f);
+    f[-2] = (uintptr_t)ip_move(gab, vm->wkid, frame_block(parent),
+                               frame_ip(f));
+    f = parent;
+  }
+
+  vm->wkid = gab.wkid;
+}
+
 a_gab_value *gab_vmexec(struct gab_triple gab, gab_value f) {
-  assert(gab_valkind(f) == kGAB_FIBER);
+  assert(gab_valkind(f) == kGAB_FIBER || gab_valkind(f) == kGAB_FIBERRUNNING);
   struct gab_obj_fiber *fiber = GAB_VAL_TO_FIBER(f);
 
+  // A running fiber was parked, pick up at the parked instruction.
+  if (fiber->header.kind == kGAB_FIBERRUNNING) {
+    struct gab_vm *vm = &fiber->vm;
+
+    if (vm->wkid != gab.wkid)
+      vm_move(gab, vm);
+
+    uint8_t *ip = vm->ip;
+    uint8_t op = *ip++;
+
+    return handlers[op](gab, ip, vm->kb, vm->fp, vm->sp);
+  }
+
   gab_value receiver = fiber->data[1];
   gab_value message = fiber->data[0];
 
@@ -876,6 +1024,24 @@ a_gab_value *gab_vmexec(struct gab_triple gab, gab_value f) {
   SEND_GUARD(gab_valkind(c) >= kGAB_CHANNEL &&                                 \
              gab_valkind(c) <= kGAB_CHANNELCLOSED)
 
+/*
+ * Park the fiber on channel c, instead of blocking the worker.
+ *
+ * The fiber is left running with its ip on the current send, and waits in
+ * line on c until c is ready for what it is waiting for (k). The send is
+ * then re-run.
+ */
+#define PARK(c, k)                                                             \
+  ({                                                                           \
+    IP() -= SEND_CACHE_DIST;                                                   \
+    STORE();                                                                   \
+    VM()->kb = KB();                                                           \
+    VM()->channel = c;                                                         \
+    VM()->waiting = k;                                                         \
+    VM()->wkid = GAB().wkid;                                                   \
+    return nullptr;                                                            \
+  })
+
 #define SEND_GUARD_CACHED_MESSAGE_SPECS()                                      \
   SEND_GUARD(gab_valeq(gab_thisfibmsgrec(GAB(), ks[GAB_SEND_KMESSAGE]),        \
                        ks[GAB_SEND_KSPECS]))
@@ -899,19 +1065,22 @@ CASE_CODE(MATCHTAILSEND_BLOCK) {
   uint8_t idx = GAB_SEND_HASH(t) * GAB_SEND_CACHE_SIZE;
 
   // TODO: Handle undefined and record case
-  if (__gab_unlikely(ks[GAB_SEND_KTYPE + idx] != t))
+  if (__gab_unlikely(ks[GAB_SEND_KPOLY + GAB_SEND_KTYPE + idx] != t))
     MISS_CACHED_SEND();
 
-  struct gab_obj_block *b = (void *)ks[GAB_SEND_KSPEC + idx];
+  struct gab_obj_block *b = (void *)ks[GAB_SEND_KPOLY + GAB_SEND_KSPEC + idx];
 
   gab_value *from = SP() - have;
   gab_value *to = FB();
 
   memmove(to, from, have * sizeof(gab_value));
 
-  IP() = (void *)ks[GAB_SEND_KOFFSET + idx];
   SP() = to + have;
 
+  ENSURE_CALLSPACE(GAB_VAL_TO_PROTOTYPE(b->p)->nslots - have);
+
+  IP() = (void *)ks[GAB_SEND_KPOLY + GAB_SEND_KOFFSET + idx];
+
   SET_BLOCK(b);
   SET_VAR(have);
 
@@ -930,19 +1099,19 @@ CASE_CODE(MATCHSEND_BLOCK) {
   uint8_t idx = GAB_SEND_HASH(t) * GAB_SEND_CACHE_SIZE;
 
   // TODO: Handle undefined and record case
-  if (__gab_unlikely(ks[GAB_SEND_KTYPE + idx] != t))
+  if (__gab_unlikely(ks[GAB_SEND_KPOLY + GAB_SEND_KTYPE + idx] != t))
     MISS_CACHED_SEND();
 
-  struct gab_obj_block *blk = (void *)ks[GAB_SEND_KSPEC + idx];
-
-  PUSH_FRAME(blk, have);
+  struct gab_obj_block *blk =
+      (void *)ks[GAB_SEND_KPOLY + GAB_SEND_KSPEC + idx];
 
   struct gab_obj_prototype *p = GAB_VAL_TO_PROTOTYPE(blk->p);
 
-  if (__gab_unlikely(!has_callspace(SP(), SB(), p->nslots - have)))
-    ERROR(GAB_OVERFLOW, "");
+  ENSURE_CALLSPACE(p->nslots - have);
+
+  PUSH_FRAME(blk, have);
 
-  IP() = (void *)ks[GAB_SEND_KOFFSET + idx];
+  IP() = (void *)ks[GAB_SEND_KPOLY + GAB_SEND_KOFFSET + idx];
   FB() = SP() - have;
 
   SET_VAR(have);
@@ -950,8 +1119,13 @@ CASE_CODE(MATCHSEND_BLOCK) {
   NEXT();
 }
 
+static inline void clear_polymorphic(gab_value *ks) {
+  for (int i = 0; i < cGAB_SEND_CACHE_LEN * GAB_SEND_CACHE_SIZE; i++)
+    ks[GAB_SEND_KPOLY + GAB_SEND_KTYPE + i] = gab_undefined;
+}
+
 static inline bool try_setup_localmatch(struct gab_triple gab, gab_value m,
-                                        gab_value *ks,
+                                        gab_value t, gab_value *ks,
                                         struct gab_obj_prototype *p) {
   gab_value specs = gab_thisfibmsgrec(gab, m);
 
@@ -961,6 +1135,8 @@ static inline bool try_setup_localmatch(struct gab_triple gab, gab_value m,
   if (gab_reclen(specs) > 4 || gab_reclen(specs) < 2)
     return false;
 
+  clear_polymorphic(ks);
+
   uint64_t len = gab_reclen(specs);
 
   for (uint64_t i = 0; i < len; i++) {
@@ -980,20 +1156,97 @@ static inline bool try_setup_localmatch(struct gab_triple gab, gab_value m,
     uint8_t idx = GAB_SEND_HASH(t) * GAB_SEND_CACHE_SIZE;
 
     // We have a collision - no point in messing about with this.
-    if (ks[GAB_SEND_KSPEC + idx] != gab_undefined)
+    if (ks[GAB_SEND_KPOLY + GAB_SEND_KSPEC + idx] != gab_undefined)
       return false;
 
     uint8_t *ip = proto_ip(gab, spec_p);
 
-    ks[GAB_SEND_KTYPE + idx] = t;
-    ks[GAB_SEND_KSPEC + idx] = (intptr_t)b;
-    ks[GAB_SEND_KOFFSET + idx] = (intptr_t)ip;
+    ks[GAB_SEND_KPOLY + GAB_SEND_KTYPE + idx] = t;
+    ks[GAB_SEND_KPOLY + GAB_SEND_KSPEC + idx] = (intptr_t)b;
+    ks[GAB_SEND_KPOLY + GAB_SEND_KOFFSET + idx] = (intptr_t)ip;
   }
 
+  // The receiver must hit one of the cases, otherwise the match would
+  // just miss back into OP_SEND.
+  uint8_t idx = GAB_SEND_HASH(t) * GAB_SEND_CACHE_SIZE;
+  if (ks[GAB_SEND_KPOLY + GAB_SEND_KTYPE + idx] != t)
+    return false;
+
   ks[GAB_SEND_KSPECS] = specs;
   return true;
 }
 
+/*
+ * Find the polymorphic cache line for receivers of type t, probing from
+ * GAB_SEND_HASH(t). If t isn't cached, this is the first empty line - or
+ * nullptr if every line is taken by another type.
+ *
+ * A polymorphic line holds the type, the implementation (spec or offset)
+ * and the status of the implementation.
+ */
+static inline gab_value *polymorphic_line(gab_value *ks, gab_value t) {
+  uint8_t h = GAB_SEND_HASH(t);
+
+  for (int i = 0; i < cGAB_SEND_CACHE_LEN; i++) {
+    uint8_t idx = ((h + i) & (cGAB_SEND_CACHE_LEN - 1)) * GAB_SEND_CACHE_SIZE;
+    gab_value *line = ks + GAB_SEND_KPOLY + idx;
+
+    if (line[GAB_SEND_KOFFSET] == gab_undefined || line[GAB_SEND_KTYPE] == t)
+      return line;
+  }
+
+  return nullptr;
+}
+
+/*
+ * Fill in the monomorphic cache line of a send site with the implementation
+ * res, resolved for receivers of type t. Returns the opcode which is
+ * specialized for that implementation.
+ */
+static inline uint8_t specialize_send(struct gab_triple gab, gab_value *ks,
+                                      struct gab_obj_prototype *proto,
+                                      uint8_t have_byte, gab_value t,
+                                      struct gab_impl_rest res) {
+  uint8_t adjust = (have_byte & fHAVE_TAIL) >> 1;
+
+  gab_value spec = res.status == kGAB_IMPL_PROPERTY
+                       ? gab_primitive(OP_SEND_PROPERTY)
+                       : res.as.spec;
+
+  ks[GAB_SEND_KTYPE] = t;
+  ks[GAB_SEND_KSPEC] = res.as.spec;
+
+  switch (gab_valkind(spec)) {
+  case kGAB_PRIMITIVE: {
+    uint8_t op = gab_valtop(spec);
+
+    if (op == OP_SEND_PRIMITIVE_CALL_BLOCK)
+      op += adjust;
+
+    return op;
+  }
+  case kGAB_BLOCK: {
+    struct gab_obj_block *b = GAB_VAL_TO_BLOCK(spec);
+    struct gab_obj_prototype *p = GAB_VAL_TO_PROTOTYPE(b->p);
+
+    uint8_t local = (p->src == proto->src);
+    adjust |= (local << 1);
+
+    if (local)
+      ks[GAB_SEND_KOFFSET] = (intptr_t)proto_ip(gab, p);
+
+    ks[GAB_SEND_KSPEC] = (intptr_t)b;
+    return OP_SEND_BLOCK + adjust;
+  }
+  case kGAB_NATIVE:
+    ks[GAB_SEND_KSPEC] = (intptr_t)GAB_VAL_TO_NATIVE(spec);
+    return OP_SEND_NATIVE;
+  default:
+    ks[GAB_SEND_KSPEC] = spec;
+    return OP_SEND_CONSTANT;
+  }
+}
+
 CASE_CODE(LOAD_UPVALUE) {
   PUSH(UPVALUE(READ_BYTE));
 
@@ -1024,6 +1277,73 @@ CASE_CODE(NLOAD_LOCAL) {
   NEXT();
 }
 
+#define FUSED_SEND_NUMERIC(CODE, value_type, operation_type, operation)        \
+  case OP_SEND_##CODE:                                                         \
+    *res = value_type((operation_type)gab_valton(a) operation                 \
+                      (operation_type)gab_valton(b));                          \
+    return true;
+
+/*
+ * Run the binary send at ip on a and b, if it is specialized for numbers.
+ * These are the same guards the specialized send itself checks.
+ */
+static inline bool send_numeric(struct gab_triple gab, uint8_t *ip,
+                                gab_value *kb, gab_value a, gab_value b,
+                                gab_value *res) {
+  gab_value *ks = kb + ((uint16_t)ip[1] << 8 | ip[2]);
+
+  if (!__gab_valisn(a) || !__gab_valisn(b))
+    return false;
+
+  if (ks[GAB_SEND_KTYPE] != gab_type(gab, kGAB_NUMBER))
+    return false;
+
+  switch (ip[0]) {
+    BINARY_NUMERIC_SENDS(FUSED_SEND_NUMERIC)
+  default:
+    return false;
+  }
+}
+
+CASE_CODE(LOAD_LOCAL_CONSTANT_SEND_NUMERIC) {
+  gab_value a = LOCAL(IP()[0]);
+  gab_value b = KB()[(uint16_t)IP()[2] << 8 | IP()[3]];
+  gab_value res;
+
+  if (__gab_likely(send_numeric(GAB(), IP() + 4, KB(), a, b, &res))) {
+    IP() += 8;
+    PUSH(res);
+    SET_VAR(1);
+    NEXT();
+  }
+
+  // Fall back to just the LOAD_LOCAL
+  PUSH(a);
+  SKIP_BYTE;
+
+  NEXT();
+}
+
+CASE_CODE(NLOAD_LOCAL_SEND_NUMERIC) {
+  gab_value a = LOCAL(IP()[1]);
+  gab_value b = LOCAL(IP()[2]);
+  gab_value res;
+
+  if (__gab_likely(send_numeric(GAB(), IP() + 3, KB(), a, b, &res))) {
+    IP() += 7;
+    PUSH(res);
+    SET_VAR(1);
+    NEXT();
+  }
+
+  // Fall back to just the NLOAD_LOCAL
+  PUSH(a);
+  PUSH(b);
+  IP() += 3;
+
+  NEXT();
+}
+
 CASE_CODE(STORE_LOCAL) {
   LOCAL(READ_BYTE) = PEEK();
 
@@ -1172,19 +1492,7 @@ CASE_CODE(SEND_PRIMITIVE_CALL_NATIVE) {
 }
 
 IMPL_SEND_UNARY_NUMERIC(PRIMITIVE_BIN, gab_number, uint64_t, ~);
-IMPL_SEND_BINARY_NUMERIC(PRIMITIVE_ADD, gab_number, double, +);
-IMPL_SEND_BINARY_NUMERIC(PRIMITIVE_SUB, gab_number, double, -);
-IMPL_SEND_BINARY_NUMERIC(PRIMITIVE_MUL, gab_number, double, *);
-IMPL_SEND_BINARY_NUMERIC(PRIMITIVE_DIV, gab_number, double, /);
-IMPL_SEND_BINARY_NUMERIC(PRIMITIVE_MOD, gab_number, uint64_t, %);
-IMPL_SEND_BINARY_NUMERIC(PRIMITIVE_BOR, gab_number, uint64_t, |);
-IMPL_SEND_BINARY_NUMERIC(PRIMITIVE_BND, gab_number, uint64_t, &);
-IMPL_SEND_BINARY_NUMERIC(PRIMITIVE_LSH, gab_number, uint64_t, <<);
-IMPL_SEND_BINARY_NUMERIC(PRIMITIVE_RSH, gab_number, uint64_t, >>);
-IMPL_SEND_BINARY_NUMERIC(PRIMITIVE_LT, gab_bool, double, <);
-IMPL_SEND_BINARY_NUMERIC(PRIMITIVE_LTE, gab_bool, double, <=);
-IMPL_SEND_BINARY_NUMERIC(PRIMITIVE_GT, gab_bool, double, >);
-IMPL_SEND_BINARY_NUMERIC(PRIMITIVE_GTE, gab_bool, double, >=);
+BINARY_NUMERIC_SENDS(IMPL_SEND_BINARY_NUMERIC)
 IMPL_SEND_UNARY_BOOLEAN(PRIMITIVE_LIN, gab_bool, bool, !);
 IMPL_SEND_BINARY_BOOLEAN(PRIMITIVE_LOR, gab_bool, bool, ||);
 IMPL_SEND_BINARY_BOOLEAN(PRIMITIVE_LND, gab_bool, bool, &&);
@@ -1329,7 +1637,7 @@ CASE_CODE(SEND_PRIMITIVE_SPLAT) {
 
   uint64_t len = gab_reclen(r);
 
-  assert(VM()->sp + len < VM()->sp + cGAB_STACK_MAX);
+  ENSURE_CALLSPACE(len);
 
   for (uint64_t i = 0; i < len; i++)
     PUSH(gab_uvrecat(r, i));
@@ -1353,7 +1661,7 @@ CASE_CODE(SEND_PRIMITIVE_SPLATKEYS) {
 
   uint64_t len = gab_reclen(r);
 
-  assert(VM()->sp + len < VM()->sp + cGAB_STACK_MAX);
+  ENSURE_CALLSPACE(len);
 
   for (uint64_t i = 0; i < len; i++)
     PUSH(gab_ukrecat(r, i));
@@ -1609,75 +1917,156 @@ CASE_CODE(SEND) {
   uint8_t adjust = (have_byte & fHAVE_TAIL) >> 1;
 
   gab_value r = PEEK_N(have);
+  gab_value t = gab_valtype(GAB(), r);
   gab_value m = ks[GAB_SEND_KMESSAGE];
-
-  if (try_setup_localmatch(GAB(), m, ks, BLOCK_PROTO())) {
+  gab_value specs = gab_thisfibmsgrec(GAB(), m);
+
+  /*
+   * If this site was already cached, and it missed on a new type of receiver
+   * (not on a change to the message's specializations), it is polymorphic.
+   */
+  uint8_t prev = *(IP() - SEND_CACHE_DIST);
+  bool polymorphic = prev != OP_SEND && prev != OP_SEND_POLYMORPHIC &&
+                     prev != OP_SEND_MEGAMORPHIC &&
+                     ks[GAB_SEND_KSPECS] == specs && ks[GAB_SEND_KTYPE] != t;
+
+  if (try_setup_localmatch(GAB(), m, t, ks, BLOCK_PROTO())) {
     WRITE_BYTE(SEND_CACHE_DIST, OP_MATCHSEND_BLOCK + adjust);
     IP() -= SEND_CACHE_DIST;
     NEXT();
   }
 
+  clear_polymorphic(ks);
+
   /* Do the expensive lookup */
   struct gab_impl_rest res = gab_impl(GAB(), m, r);
 
   if (__gab_unlikely(!res.status)) {
     STORE();
-    ERROR(GAB_IMPLEMENTATION_MISSING, FMT_MISSINGIMPL, m, r,
-          gab_valtype(GAB(), r));
+    ERROR(GAB_IMPLEMENTATION_MISSING, FMT_MISSINGIMPL, m, r, t);
   }
 
-  gab_value spec = res.status == kGAB_IMPL_PROPERTY
-                       ? gab_primitive(OP_SEND_PROPERTY)
-                       : res.as.spec;
+  ks[GAB_SEND_KSPECS] = specs;
 
-  ks[GAB_SEND_KSPECS] = gab_thisfibmsgrec(GAB(), m);
-  ks[GAB_SEND_KTYPE] = gab_valtype(GAB(), r);
-  ks[GAB_SEND_KSPEC] = res.as.spec;
+  if (polymorphic) {
+    gab_value *line = polymorphic_line(ks, t);
+    assert(line != nullptr);
 
-  switch (gab_valkind(spec)) {
-  case kGAB_PRIMITIVE: {
-    uint8_t op = gab_valtop(spec);
+    line[GAB_SEND_KTYPE] = t;
+    line[GAB_SEND_KSPEC] = res.as.spec;
+    line[GAB_SEND_KOFFSET] = res.status;
 
-    if (op == OP_SEND_PRIMITIVE_CALL_BLOCK)
-      op += adjust;
+    WRITE_BYTE(SEND_CACHE_DIST, OP_SEND_POLYMORPHIC);
+    IP() -= SEND_CACHE_DIST;
+    NEXT();
+  }
 
-    WRITE_BYTE(SEND_CACHE_DIST, op);
+  uint8_t op = specialize_send(GAB(), ks, BLOCK_PROTO(), have_byte, t, res);
 
-    break;
-  }
-  case kGAB_BLOCK: {
-    struct gab_obj_block *b = GAB_VAL_TO_BLOCK(spec);
-    struct gab_obj_prototype *p = GAB_VAL_TO_PROTOTYPE(b->p);
+  WRITE_BYTE(SEND_CACHE_DIST, op);
+  IP() -= SEND_CACHE_DIST;
 
-    uint8_t local = (GAB_VAL_TO_PROTOTYPE(b->p)->src == BLOCK_PROTO()->src);
-    adjust |= (local << 1);
+  NEXT();
+}
 
-    if (local) {
-      ks[GAB_SEND_KOFFSET] = (intptr_t)proto_ip(GAB(), p);
-    }
+/*
+ * A send site which has seen a few types of receivers keeps an implementation
+ * for each in its polymorphic lines. On a hit, the implementation is moved
+ * into the monomorphic line and the specialized handler runs as usual.
+ *
+ * Once there are more types than lines, the site becomes megamorphic.
+ */
+CASE_CODE(SEND_POLYMORPHIC) {
+  gab_value *ks = READ_CONSTANTS;
+  uint8_t have_byte = READ_BYTE;
+  uint64_t have = compute_arity(VAR(), have_byte);
 
-    ks[GAB_SEND_KSPEC] = (intptr_t)b;
-    WRITE_BYTE(SEND_CACHE_DIST, OP_SEND_BLOCK + adjust);
+  gab_value r = PEEK_N(have);
+  gab_value t = gab_valtype(GAB(), r);
+
+  gab_value *line = polymorphic_line(ks, t);
 
-    break;
+  if (__gab_unlikely(line == nullptr)) {
+    WRITE_BYTE(SEND_CACHE_DIST, OP_SEND_MEGAMORPHIC);
+    IP() -= SEND_CACHE_DIST;
+    NEXT();
   }
-  case kGAB_NATIVE: {
-    struct gab_obj_native *n = GAB_VAL_TO_NATIVE(spec);
 
-    ks[GAB_SEND_KSPEC] = (intptr_t)n;
-    WRITE_BYTE(SEND_CACHE_DIST, OP_SEND_NATIVE);
+  if (__gab_unlikely(line[GAB_SEND_KOFFSET] == gab_undefined)) {
+    gab_value m = ks[GAB_SEND_KMESSAGE];
+
+    // The other lines are stale if the specializations have changed.
+    SEND_GUARD_CACHED_MESSAGE_SPECS();
 
-    break;
+    struct gab_impl_rest res = gab_impl(GAB(), m, r);
+
+    if (__gab_unlikely(!res.status)) {
+      STORE();
+      ERROR(GAB_IMPLEMENTATION_MISSING, FMT_MISSINGIMPL, m, r, t);
+    }
+
+    line[GAB_SEND_KTYPE] = t;
+    line[GAB_SEND_KSPEC] = res.as.spec;
+    line[GAB_SEND_KOFFSET] = res.status;
   }
-  default:
-    ks[GAB_SEND_KSPEC] = spec;
-    WRITE_BYTE(SEND_CACHE_DIST, OP_SEND_CONSTANT);
-    break;
+
+  struct gab_impl_rest res = {
+      .as.spec = line[GAB_SEND_KSPEC],
+      .status = line[GAB_SEND_KOFFSET],
+  };
+
+  uint8_t op = specialize_send(GAB(), ks, BLOCK_PROTO(), have_byte, t, res);
+
+  IP() -= SEND_CACHE_DIST - 1;
+  DISPATCH(op);
+}
+
+/*
+ * Megamorphic sends don't cache anything themselves - they look up their
+ * implementation in the job's send cache.
+ */
+CASE_CODE(SEND_MEGAMORPHIC) {
+  gab_value *ks = READ_CONSTANTS;
+  uint8_t have_byte = READ_BYTE;
+  uint64_t have = compute_arity(VAR(), have_byte);
+
+  gab_value r = PEEK_N(have);
+  gab_value t = gab_valtype(GAB(), r);
+  gab_value m = ks[GAB_SEND_KMESSAGE];
+
+  gab_value messages = gab_thisfibmsg(GAB());
+  uint64_t version =
+      atomic_load_explicit(&EG()->dispatch.version, memory_order_relaxed);
+
+  struct gab_sendcache *e =
+      EG()->jobs[GAB().wkid].sendcache +
+      (gab_dispatchhash(m, t) & (cGAB_SEND_MEGACACHE_LEN - 1));
+
+  if (__gab_unlikely(e->version != version || e->messages != messages ||
+                     e->message != m || e->type != t)) {
+    struct gab_impl_rest res = gab_impl(GAB(), m, r);
+
+    if (__gab_unlikely(!res.status)) {
+      STORE();
+      ERROR(GAB_IMPLEMENTATION_MISSING, FMT_MISSINGIMPL, m, r, t);
+    }
+
+    *e = (struct gab_sendcache){
+        .version = version,
+        .messages = messages,
+        .message = m,
+        .type = t,
+        .specs = gab_thisfibmsgrec(GAB(), m),
+        .res = res,
+    };
   }
 
-  IP() -= SEND_CACHE_DIST;
+  ks[GAB_SEND_KSPECS] = e->specs;
 
-  NEXT();
+  uint8_t op = specialize_send(GAB(), ks, BLOCK_PROTO(), have_byte, t, e->res);
+
+  IP() -= SEND_CACHE_DIST - 1;
+  DISPATCH(op);
 }
 
 CASE_CODE(SEND_PRIMITIVE_CALL_MESSAGE_PROPERTY) {
@@ -1876,7 +2265,10 @@ CASE_CODE(SEND_PRIMITIVE_TAKE) {
   SEND_GUARD_ISC(c);
 
   STORE_SP();
-  gab_value v = gab_chntake(GAB(), c);
+  gab_value v = gab_chntrytake(GAB(), c);
+
+  if (v == gab_undefined && !gab_chnisclosed(c))
+    PARK(c, kGAB_CHNWAIT_TAKE);
 
   DROP_N(have);
 
@@ -1901,15 +2293,32 @@ CASE_CODE(SEND_PRIMITIVE_PUT) {
 
   SEND_GUARD_ISC(c);
 
-  if (__gab_unlikely(have < 2))
-    PUSH(gab_nil), have++;
+  struct gab_obj_channel *channel = GAB_VAL_TO_CHANNEL(c);
 
-  gab_value v = PEEK_N(have - 1);
+  if (!VM()->put_pending && !gab_chnisclosed(c)) {
+    gab_value v = have < 2 ? gab_nil : PEEK_N(have - 1);
 
-  STORE_SP();
-  gab_chnput(GAB(), c, v);
+    STORE_SP();
+    if (!gab_chntryput(GAB(), c, v))
+      PARK(c, kGAB_CHNWAIT_PUT);
 
-  DROP_N(have - 1);
+    // A buffered put is done once the value is in the buffer.
+    VM()->put_pending = !channel->len;
+  }
+
+  // Unbuffered channels wait for a taker.
+  if (VM()->put_pending && gab_chnisfull(c)) {
+    if (!gab_chnisclosed(c))
+      PARK(c, kGAB_CHNWAIT_TAKER);
+
+    // A taker never arrives, remove our value as if the put failed.
+    gab_chntrytake(GAB(), c);
+  }
+
+  VM()->put_pending = false;
+
+  if (have > 1)
+    DROP_N(have - 1);
 
   SET_VAR(1);
 
@@ -1946,8 +2355,26 @@ CASE_CODE(SEND_PRIMITIVE_CHANNEL) {
 
   SEND_GUARD_CACHED_RECEIVER_TYPE(PEEK_N(have));
 
+  uint64_t len = 0;
+
+  if (have > 1) {
+    gab_value n = PEEK_N(have - 1);
+
+    ERROR_GUARD_KIND(n, kGAB_NUMBER);
+
+    double d = gab_valton(n);
+
+    if (__gab_unlikely(!(d >= 0 && d <= cGAB_CHANNEL_MAX_LEN) ||
+                       d != (uint64_t)d))
+      ERROR(GAB_PANIC,
+            "Channel capacity must be a whole number from 0 to $, got $",
+            gab_number(cGAB_CHANNEL_MAX_LEN), n);
+
+    len = d;
+  }
+
   STORE_SP();
-  gab_value chan = gab_channel(GAB());
+  gab_value chan = gab_channel(GAB(), len);
 
   DROP_N(have);
   PUSH(chan);
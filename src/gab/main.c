@@ -6,9 +6,17 @@
 
 #define MAIN_MODULE "gab\\main"
 
+#ifndef GAB_PREFIX
+#define GAB_PREFIX "."
+#endif
+
+// Compiled modules are cached here, if the directory exists.
+#define GAB_CACHE GAB_PREFIX "/gab/cache"
+
 void run_repl(int flags) {
   struct gab_triple gab = gab_create((struct gab_create_argt){
       .flags = flags,
+      .cache = GAB_CACHE,
   });
 
   gab_repl(
@@ -35,6 +43,7 @@ void run_string(const char *string, int flags, size_t jobs) {
   struct gab_triple gab = gab_create((struct gab_create_argt){
       .flags = flags,
       .jobs = jobs,
+      .cache = GAB_CACHE,
   });
 
   // This is a weird case where we actually want to include the null terminator
@@ -50,6 +59,7 @@ void run_file(const char *path, int flags, size_t jobs) {
   struct gab_triple gab = gab_create((struct gab_create_argt){
       .flags = flags,
       .jobs = jobs,
+      .cache = GAB_CACHE,
   });
 
   a_gab_value *result = gab_suse(gab, path);
@@ -225,18 +235,23 @@ struct parse_options_result parse_options(int argc, const char **argv,
       return (struct parse_options_result){argc - i, flags};
 
     if (argv[i][1] == '-') {
+      bool found = false;
+
       for (int j = 0; j < MAX_OPTIONS; j++) {
         struct option opt = command.options[j];
 
         if (opt.name && !strcmp(argv[i] + 2, opt.name)) {
           flags |= opt.flag;
+          found = true;
           break;
         }
       }
 
+      if (found)
+        continue;
+
       printf("UNRECOGNIZED FLAG: %s\n", argv[i]);
       exit(1);
-      continue;
     } else {
       for (int j = 0; j < MAX_OPTIONS; j++) {
         struct option opt = command.options[j];
@@ -2,15 +2,22 @@
 #include "os.h"
 
 a_char *gab_fosread(FILE *fd) {
-  v_char buffer = {0};
+  v_char buffer;
+  v_char_create(&buffer, 4096);
 
-  while (1) {
-    int c = fgetc(fd);
+  // Read in chunks, growing the buffer as needed. Reading a character at a
+  // time was most of the time spent loading a module.
+  for (;;) {
+    if (buffer.cap - buffer.len < 4096)
+      v_char_cap(&buffer, buffer.cap * 2);
 
-    if (c == EOF)
-      break;
+    uint64_t n = fread(buffer.data + buffer.len, sizeof(char),
+                       buffer.cap - buffer.len, fd);
 
-    v_char_push(&buffer, c);
+    buffer.len += n;
+
+    if (n == 0)
+      break;
   }
 
   v_char_push(&buffer, '\0');
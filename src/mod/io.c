@@ -91,21 +91,73 @@ a_gab_value *gab_iolib_scan(struct gab_triple gab, uint64_t argc,
     return nullptr;
   }
 
-  char buffer[bytes];
+  // This may be too big for the stack.
+  char *buffer = malloc(bytes);
+
+  if (buffer == nullptr) {
+    gab_vmpush(gab_vm(gab), gab_err, gab_string(gab, strerror(errno)));
+    return nullptr;
+  }
 
   FILE *stream = *(FILE **)gab_boxdata(argv[0]);
 
   // Try to read bytes number of bytes
-  int bytes_read = fread(buffer, 1, sizeof(buffer), stream);
+  uint64_t bytes_read = fread(buffer, 1, bytes, stream);
 
   if (bytes_read < bytes)
     gab_vmpush(gab_vm(gab), gab_err, gab_string(gab, strerror(errno)));
   else
     gab_vmpush(gab_vm(gab), gab_ok, gab_nstring(gab, bytes_read, buffer));
 
+  free(buffer);
   return nullptr;
 }
 
+/*
+ * Read the whole of a stream into a new buffer. Whole files are often too
+ * big for the stack.
+ *
+ * Streams which can't seek (pipes, terminals) don't know their size up
+ * front, so they are read from where they are, a chunk at a time.
+ */
+static char *readall(FILE *file, uint64_t *len) {
+  uint64_t cap = 4096, n = 0;
+
+  if (fseek(file, 0L, SEEK_END) == 0) {
+    long size = ftell(file);
+
+    // One byte more than the file, so that the read finds its end.
+    if (size >= 0 && fseek(file, 0L, SEEK_SET) == 0)
+      cap = size + 1;
+  }
+
+  char *buffer = malloc(cap);
+
+  if (buffer == nullptr)
+    return nullptr;
+
+  for (;;) {
+    n += fread(buffer + n, sizeof(char), cap - n, file);
+
+    if (n < cap)
+      break;
+
+    cap *= 2;
+    char *grown = realloc(buffer, cap);
+
+    if (grown == nullptr)
+      return free(buffer), nullptr;
+
+    buffer = grown;
+  }
+
+  if (ferror(file))
+    return free(buffer), nullptr;
+
+  *len = n;
+  return buffer;
+}
+
 a_gab_value *gab_iolib_read(struct gab_triple gab, uint64_t argc,
                             gab_value argv[argc]) {
   if (argc != 1 || gab_valkind(argv[0]) != kGAB_BOX)
@@ -113,21 +165,17 @@ a_gab_value *gab_iolib_read(struct gab_triple gab, uint64_t argc,
 
   FILE *file = *(FILE **)gab_boxdata(argv[0]);
 
-  fseek(file, 0L, SEEK_END);
-  uint64_t fileSize = ftell(file);
-  rewind(file);
-
-  char buffer[fileSize];
-
-  uint64_t bytesRead = fread(buffer, sizeof(char), fileSize, file);
+  uint64_t fileSize;
+  char *buffer = readall(file, &fileSize);
 
-  if (bytesRead < fileSize) {
+  if (buffer == nullptr) {
     gab_vmpush(gab_vm(gab), gab_string(gab, "FILE_COULD_NOT_READ"));
     return nullptr;
   }
 
-  gab_vmpush(gab_vm(gab), gab_ok, gab_nstring(gab, bytesRead, buffer));
+  gab_vmpush(gab_vm(gab), gab_ok, gab_nstring(gab, fileSize, buffer));
 
+  free(buffer);
   return nullptr;
 }
 
@@ -10,7 +10,7 @@ a_gab_value *gab_msglib_message(struct gab_triple gab, uint64_t argc,
   if (gab_valkind(name) != kGAB_STRING)
     return gab_pktypemismatch(gab, name, kGAB_STRING);
 
-  gab_vmpush(gab_vm(gab), gab_strtomsg(name));
+  gab_vmpush(gab_vm(gab), gab_strtomsg(gab_valintern(gab, name)));
   return nullptr;
 }
 
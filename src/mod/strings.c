@@ -15,7 +15,7 @@ a_gab_value *gab_strlib_trim(struct gab_triple gab, uint64_t argc,
   gab_value str = gab_arg(0);
   gab_value trimset = gab_arg(1);
 
-  const char *cstr = gab_strdata(&str);
+  const char *cstr = gab_strbytes(&str);
   const char *ctrimset = nullptr;
   uint64_t cstrlen = gab_strlen(str);
 
@@ -43,7 +43,7 @@ a_gab_value *gab_strlib_trim(struct gab_triple gab, uint64_t argc,
 
   uint64_t result_len = back - front + 1;
 
-  gab_vmpush(gab_vm(gab), gab_nstring(gab, result_len, front));
+  gab_vmpush(gab_vm(gab), gab_strslice(gab, str, front - cstr, result_len));
   return nullptr;
 }
 
@@ -61,8 +61,8 @@ a_gab_value *gab_strlib_split(struct gab_triple gab, uint64_t argc,
   if (cstr_len == 0 || csep_len == 0)
     return nullptr;
 
-  const char *cstr = gab_strdata(&str);
-  const char *csep = gab_strdata(&sep);
+  const char *cstr = gab_strbytes(&str);
+  const char *csep = gab_strbytes(&sep);
   const char sepstart = csep[0];
 
   uint64_t offset = 0, begin = 0;
@@ -73,7 +73,7 @@ a_gab_value *gab_strlib_split(struct gab_triple gab, uint64_t argc,
       // Memcmp to test for full sep match
       if (!memcmp(cstr + offset, csep, csep_len)) {
         // Full match found - push a string
-        gab_vmpush(gab_vm(gab), gab_nstring(gab, offset - begin, cstr + begin));
+        gab_vmpush(gab_vm(gab), gab_strslice(gab, str, begin, offset - begin));
         begin = offset + csep_len;
         offset = begin;
         continue;
@@ -83,7 +83,7 @@ a_gab_value *gab_strlib_split(struct gab_triple gab, uint64_t argc,
     offset++;
   }
 
-  gab_vmpush(gab_vm(gab), gab_nstring(gab, cstr_len - begin, cstr + begin));
+  gab_vmpush(gab_vm(gab), gab_strslice(gab, str, begin, cstr_len - begin));
 
   return nullptr;
 }
@@ -291,8 +291,6 @@ a_gab_value *gab_strlib_at(struct gab_triple gab, uint64_t argc,
 
 a_gab_value *gab_strlib_slice(struct gab_triple gab, uint64_t argc,
                               gab_value argv[argc]) {
-  const char *str = gab_strdata(argv + 0);
-
   uint64_t len = gab_strlen(argv[0]);
   uint64_t start = 0, end = len;
 
@@ -331,7 +329,7 @@ a_gab_value *gab_strlib_slice(struct gab_triple gab, uint64_t argc,
 
   uint64_t size = end - start;
 
-  gab_value res = gab_nstring(gab, size, str + start);
+  gab_value res = gab_strslice(gab, argv[0], start, size);
 
   gab_vmpush(gab_vm(gab), res);
   return nullptr;
@@ -383,13 +381,13 @@ a_gab_value *gab_numlib_binary_into(struct gab_triple gab, uint64_t argc,
 
 a_gab_value *gab_strlib_sigil_into(struct gab_triple gab, uint64_t argc,
                                    gab_value argv[argc]) {
-  gab_vmpush(gab_vm(gab), gab_strtosig(gab_arg(0)));
+  gab_vmpush(gab_vm(gab), gab_strtosig(gab_valintern(gab, gab_arg(0))));
   return nullptr;
 }
 
 a_gab_value *gab_strlib_messages_into(struct gab_triple gab, uint64_t argc,
                                       gab_value argv[argc]) {
-  gab_vmpush(gab_vm(gab), gab_strtomsg(gab_arg(0)));
+  gab_vmpush(gab_vm(gab), gab_strtomsg(gab_valintern(gab, gab_arg(0))));
   return nullptr;
 }
 
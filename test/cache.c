@@ -0,0 +1,189 @@
+/*
+ * Check that \use caches compiled modules: a second engine loads the cached
+ * object, and a changed source, an object from another version of gab, or an
+ * object which is cut short or isn't one at all is compiled again.
+ *
+ *  cc -std=c2x -O2 -I../include -I../vendor -DGAB_PLATFORM_UNIX \
+ *    -D_POSIX_C_SOURCE=200809L cache.c ../src/cgab/*.c ../src/mod/*.c \
+ *    ../src/gab/os.c -lm -o cache && ./cache
+ */
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "gab.h"
+
+#define CACHE "cache"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                            \
+  if (!(cond)) {                                                               \
+    fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);  \
+    failures++;                                                                \
+  }
+
+static void write_module(const char *source) {
+  FILE *f = fopen("thing.gab", "w");
+  fputs(source, f);
+  fclose(f);
+}
+
+/*
+ * Use the module in a fresh engine, returning the number it evaluates to.
+ */
+static double use_module() {
+  struct gab_triple gab = gab_create((struct gab_create_argt){
+      .cache = CACHE,
+  });
+
+  a_gab_value *res = gab_suse(gab, "thing");
+
+  double n = -1;
+
+  // The first value is the module's main block, followed by what it returned.
+  if (res && res->len > 1 && gab_valkind(res->data[1]) == kGAB_NUMBER)
+    n = gab_valton(res->data[1]);
+
+  gab_destroy(gab);
+  return n;
+}
+
+/*
+ * Find the module's object in the cache. There is only one module, so it is
+ * the only object there.
+ */
+static bool cached_object(char *path, uint64_t len) {
+  DIR *dir = opendir(CACHE);
+  struct dirent *e;
+  bool found = false;
+
+  while ((e = readdir(dir))) {
+    uint64_t n = strlen(e->d_name);
+
+    if (n > 5 && !strcmp(e->d_name + n - 5, ".gbof")) {
+      snprintf(path, len, CACHE "/%s", e->d_name);
+      found = true;
+    }
+  }
+
+  closedir(dir);
+  return found;
+}
+
+// A new object is moved into place over the old one, so it has a new inode.
+static ino_t object_inode(const char *path) {
+  struct stat st;
+  return stat(path, &st) ? 0 : st.st_ino;
+}
+
+static uint32_t object_version(const char *path) {
+  uint32_t version = 0;
+
+  FILE *f = fopen(path, "rb");
+  fseek(f, 4, SEEK_SET);
+  fread(&version, sizeof(version), 1, f);
+  fclose(f);
+
+  return version;
+}
+
+static uint64_t object_size(const char *path) {
+  struct stat st;
+  return stat(path, &st) ? 0 : st.st_size;
+}
+
+static void write_garbage(const char *path) {
+  FILE *f = fopen(path, "wb");
+
+  for (int i = 0; i < 4096; i++)
+    fputc(rand() & 0xff, f);
+
+  fclose(f);
+}
+
+static void set_object_version(const char *path, uint32_t version) {
+  FILE *f = fopen(path, "r+b");
+  fseek(f, 4, SEEK_SET);
+  fwrite(&version, sizeof(version), 1, f);
+  fclose(f);
+}
+
+int main() {
+  char dir[] = "/tmp/gab-cache-XXXXXX";
+
+  if (!mkdtemp(dir) || chdir(dir) || mkdir(CACHE, 0700)) {
+    perror("gab-cache");
+    return 1;
+  }
+
+  char obj[1024];
+
+  // A miss writes the object.
+  write_module("41 + 1\n");
+  CHECK(use_module() == 42);
+  CHECK(cached_object(obj, sizeof(obj)));
+  CHECK(object_version(obj) == GAB_GBOF_VERSION);
+
+  // A hit loads it, and leaves it alone.
+  ino_t ino = object_inode(obj);
+  CHECK(use_module() == 42);
+  CHECK(object_inode(obj) == ino);
+
+  // A changed source misses, and replaces it - even if a writer died and
+  // left its temporary file behind.
+  char tmp[sizeof(obj) + 4];
+  snprintf(tmp, sizeof(tmp), "%s.tmp", obj);
+  fclose(fopen(tmp, "w"));
+
+  write_module("42 + 1\n");
+  CHECK(use_module() == 43);
+  CHECK(object_inode(obj) != ino);
+
+  remove(tmp);
+
+  // So does an object from another version.
+  set_object_version(obj, GAB_GBOF_VERSION + 1);
+  ino = object_inode(obj);
+  CHECK(use_module() == 43);
+  CHECK(object_inode(obj) != ino);
+  CHECK(object_version(obj) == GAB_GBOF_VERSION);
+
+  // And an object which was cut short.
+  uint64_t size = object_size(obj);
+  CHECK(truncate(obj, size / 2) == 0);
+  CHECK(use_module() == 43);
+  CHECK(object_size(obj) == size);
+
+  // And one which isn't an object at all.
+  write_garbage(obj);
+  CHECK(use_module() == 43);
+  CHECK(object_size(obj) == size);
+  CHECK(object_version(obj) == GAB_GBOF_VERSION);
+
+  // No temporary files are left behind.
+  DIR *d = opendir(CACHE);
+  struct dirent *e;
+  uint64_t nfiles = 0;
+
+  while ((e = readdir(d)))
+    nfiles += e->d_name[0] != '.';
+
+  closedir(d);
+  CHECK(nfiles == 1);
+
+  remove(obj);
+  remove("thing.gab");
+  rmdir(CACHE);
+  chdir("/");
+  rmdir(dir);
+
+  if (failures)
+    return fprintf(stderr, "%d checks failed\n", failures), 1;
+
+  printf("cache ok\n");
+  return 0;
+}
@@ -0,0 +1,298 @@
+/*
+ * Check what the garbage collector does that gab code can't see: sharing
+ * big collections with helpers, recording its pauses, freeing cycles, and
+ * giving back the slabs a burst of allocation emptied.
+ *
+ *  cc -std=c2x -O2 -I../include -I../vendor -DGAB_PLATFORM_UNIX \
+ *    -D_POSIX_C_SOURCE=200809L gc.c ../src/cgab/*.c ../src/mod/*.c \
+ *    ../src/gab/os.c -lm -o gc && ./gc
+ */
+#include <dirent.h>
+#include <malloc.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "engine.h"
+#include "gab.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                            \
+  if (!(cond)) {                                                               \
+    fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);  \
+    failures++;                                                                \
+  }
+
+/*
+ * Run a program to completion, returning the number it evaluates to.
+ */
+static double run(struct gab_triple gab, const char *name,
+                  const char *program) {
+  a_gab_value *res = gab_exec(gab, (struct gab_exec_argt){
+                                       .name = name,
+                                       .source = program,
+                                       .flags = gab.flags,
+                                   });
+
+  // The first value is the fiber's status, followed by what it returned.
+  // The values belong to the fiber, which frees them when it is collected.
+  if (res && res->len > 1 && res->data[0] == gab_ok &&
+      gab_valkind(res->data[1]) == kGAB_NUMBER)
+    return gab_valton(res->data[1]);
+
+  return -1;
+}
+
+/*
+ * Run a collection, and wait for it to finish.
+ */
+static void collect(struct gab_triple gab) {
+  gab_collect(gab);
+
+  for (;;) {
+    uint64_t key = gab_wlkey(&gab.eg->lifecycle);
+
+    if (gab.eg->gc->schedule < 0)
+      break;
+
+    gab_wlwait(gab, &gab.eg->lifecycle, key, -1);
+  }
+}
+
+static uint64_t npauses(struct gab_triple gab) {
+  uint64_t buckets[GAB_GCNPAUSES], n = 0;
+
+  for (uint64_t i = 0; i < gab_gcpauses(gab, GAB_GCNPAUSES, buckets); i++)
+    n += buckets[i];
+
+  return n;
+}
+
+/*
+ * Many fibers allocate records as fast as they can, so that collections are
+ * big enough to be shared with the helper threads.
+ */
+static const char *stress = "\\do_sum:defcase! {\n"
+                            "  .true (n acc) => acc\n"
+                            "  .false (n acc) => (n - 1):sum(acc + n)\n"
+                            "}\n"
+                            "\\sum:def!('gab.number' acc => do\n"
+                            "  [self, { .n self }]\n"
+                            "  (self < 1):do_sum(self acc)\n"
+                            "end)\n"
+                            "\\do_spawn:defcase! {\n"
+                            "  .true (n ch) => n\n"
+                            "  .false (n ch) => do\n"
+                            "    .gab.fiber:make () => ch <! 20000:sum(0)\n"
+                            "    (n - 1):spawn ch\n"
+                            "  end\n"
+                            "}\n"
+                            "\\spawn:def!('gab.number' ch => do\n"
+                            "  (self < 1):do_spawn(self ch)\n"
+                            "end)\n"
+                            "\\do_gather:defcase! {\n"
+                            "  .true (n ch acc) => acc\n"
+                            "  .false (n ch acc) => do\n"
+                            "    (_ v) = ch:>!\n"
+                            "    (n - 1):gather(ch, acc + v)\n"
+                            "  end\n"
+                            "}\n"
+                            "\\gather:def!('gab.number' (ch acc) => do\n"
+                            "  (self < 1):do_gather(self ch acc)\n"
+                            "end)\n"
+                            "ch = .gab.channel:make\n"
+                            "32:spawn ch\n"
+                            "32:gather(ch 0)\n";
+
+static void test_stress() {
+  struct gab_triple gab = gab_create((struct gab_create_argt){
+      .jobs = 8,
+  });
+
+  CHECK(run(gab, "stress", stress) == 32 * (20000.0 * 20001 / 2));
+
+  // The collections were big enough to share.
+  CHECK(gab.eg->gc->help.nhelpers > 0);
+
+  gab_destroy(gab);
+}
+
+static void test_pauses() {
+  struct gab_triple gab = gab_create((struct gab_create_argt){});
+
+  uint64_t buckets[GAB_GCNPAUSES + 1];
+  CHECK(gab_gcpauses(gab, GAB_GCNPAUSES + 1, buckets) == GAB_GCNPAUSES);
+
+  // Each collection records at least one pause.
+  uint64_t before = npauses(gab);
+  collect(gab);
+  CHECK(npauses(gab) > before);
+
+  before = npauses(gab);
+  CHECK(run(gab, "pauses", "1 + 1\n") == 2);
+  collect(gab);
+  collect(gab);
+  CHECK(npauses(gab) >= before + 2);
+
+  gab_destroy(gab);
+}
+
+/*
+ * Count the bytes the engine has allocated, like bench/alloc.
+ */
+static _Atomic uint64_t live;
+
+static void *counting_alloc(void *ctx, void *ptr, uint64_t size) {
+  if (ptr) {
+    atomic_fetch_sub(&live, size);
+    free(ptr);
+    return nullptr;
+  }
+
+  ptr = malloc(size);
+
+  if (ptr)
+    atomic_fetch_add(&live, size);
+
+  return ptr;
+}
+
+/*
+ * The bytes held by objects, leaving out the chunks the collector keeps
+ * pooled for its buffers. Each has the hook's size header.
+ */
+static uint64_t objbytes(struct gab_triple gab) {
+  return live -
+         gab.eg->gc->pool.len * (sizeof(struct gab_gcchunk) + sizeof(uint64_t));
+}
+
+static uint64_t nfds() {
+  DIR *dir = opendir("/proc/self/fd");
+  uint64_t n = 0;
+
+  if (dir == nullptr)
+    return 0;
+
+  while (readdir(dir))
+    n++;
+
+  closedir(dir);
+  return n;
+}
+
+/*
+ * Each record holds a channel which holds the record, and a box which holds
+ * an open file. Nothing else refers to them once the loop moves on.
+ */
+static const char *cycles = "\\do_cycles:defcase! {\n"
+                            "  .true n => n\n"
+                            "  .false n => do\n"
+                            "    ch = .gab.channel:make 1\n"
+                            "    (_ box) = '/dev/null' :io.open 'w'\n"
+                            "    ch <! { .ch ch .box box }\n"
+                            "    (n - 1):cycles\n"
+                            "  end\n"
+                            "}\n"
+                            "\\cycles:def!('gab.number' () => do\n"
+                            "  (self < 1):do_cycles(self)\n"
+                            "end)\n"
+                            "0\n";
+
+/*
+ * Collect until nothing more is freed. Finding a cycle takes more than one
+ * collection: its last decrement is processed by the one after it happened,
+ * and what that one finds is only freed once the next one confirms it.
+ */
+static void collect_all(struct gab_triple gab) {
+  uint64_t last = UINT64_MAX;
+
+  for (int i = 0; i < 32 && live != last; i++) {
+    last = live;
+    collect(gab);
+    collect(gab);
+  }
+}
+
+static void test_cycles() {
+  struct gab_triple gab = gab_create((struct gab_create_argt){
+      .os_objalloc = counting_alloc,
+  });
+
+  CHECK(run(gab, "cycles", cycles) == 0);
+
+  // Make a few first, so that what stays alive for any number of them (like
+  // the record's shape) is already counted.
+  CHECK(run(gab, "few", "10:cycles\n") == 0);
+  collect_all(gab);
+  uint64_t before = objbytes(gab), fds = nfds();
+
+  CHECK(run(gab, "many", "1000:cycles\n") == 0);
+  collect_all(gab);
+
+  // A leaked cycle is a record, a channel and a box - much more than this.
+  CHECK(objbytes(gab) < before + 1000 * 16);
+
+  // Freeing the boxes closed their files.
+  CHECK(nfds() <= fds);
+
+  gab_destroy(gab);
+}
+
+/*
+ * Fill a channel with records, all alive at once, and then drop it.
+ */
+static const char *burst = "\\do_fill:defcase! {\n"
+                           "  .true (n ch) => 0\n"
+                           "  .false (n ch) => do\n"
+                           "    ch <! { .a n .b n .c n .d n .e n .f n .g n }\n"
+                           "    (n - 1):fill ch\n"
+                           "  end\n"
+                           "}\n"
+                           "\\fill:def!('gab.number' ch => do\n"
+                           "  (self < 1):do_fill(self ch)\n"
+                           "end)\n"
+                           "0\n";
+
+static void test_slabs() {
+  // Keep every thread's allocations in the arena mallinfo2 counts.
+  mallopt(M_ARENA_MAX, 1);
+
+  struct gab_triple gab = gab_create((struct gab_create_argt){});
+
+  CHECK(run(gab, "burst", burst) == 0);
+  CHECK(run(gab, "few", "10:fill(.gab.channel:make 10)\n") == 0);
+
+  for (int i = 0; i < 8; i++)
+    collect(gab);
+
+  uint64_t before = mallinfo2().uordblks;
+
+  CHECK(run(gab, "many", "60000:fill(.gab.channel:make 60000)\n") == 0);
+
+  uint64_t took = mallinfo2().uordblks - before;
+
+  // Dying all at once, the records are freed in slices over the next
+  // collections.
+  for (int i = 0; i < 8 || gab.eg->gc->dead.len; i++)
+    collect(gab);
+
+  // Most of what the burst took was slabs, which are given back once its
+  // records are freed. The rest is the collector's own buffers.
+  CHECK(mallinfo2().uordblks < before + took / 2);
+
+  gab_destroy(gab);
+}
+
+int main() {
+  test_stress();
+  test_pauses();
+  test_cycles();
+  test_slabs();
+
+  if (failures)
+    return fprintf(stderr, "%d checks failed\n", failures), 1;
+
+  printf("gc ok\n");
+  return 0;
+}